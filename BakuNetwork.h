@@ -0,0 +1,155 @@
+#ifndef BAKU_NETWORK_H
+#define BAKU_NETWORK_H
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+// The built-in Baku Metro network as compile-time tables. Nothing here is
+// constructed at runtime; station names resolve to IDs through a perfect hash
+// whose seed the compiler finds.
+namespace baku {
+
+struct Station {
+    std::string_view name;
+    int traffic; // base boarding demand
+};
+
+struct Segment {
+    int from;
+    int to;
+    double km;
+};
+
+struct Line {
+    std::string_view name;
+    int first;      // offset into kLineStops
+    int stop_count;
+    int hub;        // station ID
+    bool is_shuttle;
+
+    constexpr int stop(int index) const;
+};
+
+inline constexpr std::array<Station, 27> kStations = {{
+    {"Icheri Sheher", 300}, {"Sahil", 250}, {"28 May", 400}, {"Ganjlik", 200},
+    {"Nariman Narimanov", 220}, {"Bakmil", 100}, {"Ulduz", 150}, {"Koroglu", 250},
+    {"Kara Karaev", 180}, {"Neftchilar", 150}, {"Khalglar Dostlugu", 200}, {"Ahmedli", 220},
+    {"Azi Aslanov", 180}, {"Darnagul", 170}, {"Azadlig Prospekti", 190}, {"Nasimi", 210},
+    {"Memar Ajami", 230}, {"20 January", 220}, {"Inshaatchilar", 180}, {"Elmlar Akademiyasy", 200},
+    {"Nizami", 250}, {"Khojasan", 80}, {"Avtovagzal", 180}, {"Memar Acemi 2", 300},
+    {"8 Noyabr", 220}, {"Jafar Jabbarly", 200}, {"Hatai", 100}
+}};
+inline constexpr int kStationCount = static_cast<int>(kStations.size());
+
+inline constexpr std::array<Segment, 24> kSegments = {{
+    {0, 1, 0.9}, {1, 2, 0.5}, {2, 3, 1.6}, {3, 4, 2.1}, {4, 5, 1.3}, {5, 6, 1.9},
+    {6, 7, 2.3}, {7, 8, 1.8}, {8, 9, 1.2}, {9, 10, 1.1}, {10, 11, 1.6}, {11, 12, 1.3},
+    {13, 14, 1.1}, {14, 15, 2.1}, {15, 16, 2.66}, {16, 17, 1.8}, {17, 18, 1.3}, {18, 19, 0.9},
+    {19, 20, 1.2}, {20, 2, 1.7},
+    {21, 22, 2.0}, {22, 23, 2.0}, {23, 24, 1.5},
+    {25, 26, 1.0}
+}};
+
+inline constexpr std::array<int, 38> kLineStops = {{
+    // Red
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12,
+    // Green
+    13, 14, 15, 16, 17, 18, 19, 20, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12,
+    // Purple
+    21, 22, 23, 24,
+    // Light Green
+    25, 26
+}};
+
+inline constexpr std::array<Line, 4> kLines = {{
+    {"Red", 0, 13, 5, false},
+    {"Green", 13, 19, 5, false},
+    {"Purple", 32, 4, 21, false},
+    {"Light Green", 36, 2, 26, true}
+}};
+inline constexpr int kLineCount = static_cast<int>(kLines.size());
+
+constexpr int Line::stop(int index) const { return kLineStops[first + index]; }
+
+// Symmetric km matrix; 0 where stations are not adjacent.
+constexpr std::array<std::array<double, kStationCount>, kStationCount> build_distances() {
+    std::array<std::array<double, kStationCount>, kStationCount> table{};
+    for (const auto& segment : kSegments) {
+        table[segment.from][segment.to] = segment.km;
+        table[segment.to][segment.from] = segment.km;
+    }
+    return table;
+}
+inline constexpr auto kDistances = build_distances();
+
+// Number of lines calling at each station.
+constexpr std::array<int, kStationCount> build_lines_at_station() {
+    std::array<int, kStationCount> table{};
+    for (const auto& line : kLines) {
+        for (int i = 0; i < line.stop_count; ++i) {
+            table[line.stop(i)]++;
+        }
+    }
+    return table;
+}
+inline constexpr auto kLinesAtStation = build_lines_at_station();
+
+// Perfect hash: FNV-1a with a seed, folded into a 64-slot table.
+inline constexpr int kHashSlots = 64;
+
+constexpr std::uint32_t hash_name(std::string_view name, std::uint32_t seed) {
+    std::uint32_t hash = 2166136261u ^ seed;
+    for (char c : name) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 16777619u;
+    }
+    hash ^= hash >> 16;
+    return hash % kHashSlots;
+}
+
+constexpr std::uint32_t find_hash_seed() {
+    for (std::uint32_t seed = 0;; ++seed) {
+        bool used[kHashSlots] = {};
+        bool collision = false;
+        for (const auto& station : kStations) {
+            std::uint32_t slot = hash_name(station.name, seed);
+            if (used[slot]) {
+                collision = true;
+                break;
+            }
+            used[slot] = true;
+        }
+        if (!collision) return seed;
+    }
+}
+inline constexpr std::uint32_t kHashSeed = find_hash_seed();
+
+constexpr std::array<std::int8_t, kHashSlots> build_slots() {
+    std::array<std::int8_t, kHashSlots> slots{};
+    for (auto& slot : slots) slot = -1;
+    for (int id = 0; id < kStationCount; ++id) {
+        slots[hash_name(kStations[id].name, kHashSeed)] = static_cast<std::int8_t>(id);
+    }
+    return slots;
+}
+inline constexpr auto kSlots = build_slots();
+
+// Station ID for a name, or -1 if the network has no such station.
+constexpr int station_id(std::string_view name) {
+    int id = kSlots[hash_name(name, kHashSeed)];
+    return (id >= 0 && kStations[id].name == name) ? id : -1;
+}
+
+constexpr bool all_stations_hash() {
+    for (int id = 0; id < kStationCount; ++id) {
+        if (station_id(kStations[id].name) != id) return false;
+    }
+    return true;
+}
+static_assert(all_stations_hash(), "perfect hash must map every station to itself");
+static_assert(station_id("Depo") == -1, "unknown names must not resolve");
+
+} // namespace baku
+
+#endif // BAKU_NETWORK_H
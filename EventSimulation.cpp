@@ -0,0 +1,646 @@
+#include "EventSimulation.h"
+#include "Mailbox.h"
+#include "ShardTransport.h"
+#include <algorithm>
+#include <array>
+#include <condition_variable>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <thread>
+
+namespace {
+
+const long long kMsPerHour = 3600LL * 1000;
+const double kSpeedKmh = 40.0;
+const double kFaultCost = 50.0;
+const int kTransferPercent = 20;
+const unsigned long long kFnvBasis = 14695981039346656037ULL;
+
+enum class EventKind { Arrive, Dock, Depart, Transfer };
+
+struct Event {
+    long long time_ms;
+    int source;
+    unsigned long long seq;
+    EventKind kind;
+    int train;
+    int stop;
+    int riders;
+};
+
+// Orders the queue by (time, source partition, source sequence). The key is
+// unique across partitions, so processing order never depends on thread timing.
+struct LaterEvent {
+    bool operator()(const Event& a, const Event& b) const {
+        if (a.time_ms != b.time_ms) return a.time_ms > b.time_ms;
+        if (a.source != b.source) return a.source > b.source;
+        return a.seq > b.seq;
+    }
+};
+
+struct TrainState {
+    int id;
+    int stop;
+    int direction;
+    int riders;
+    int max_riders;
+    std::mt19937 rng;
+    // Summed over the riders on board, so alighting riders take the average.
+    double onboard_since_ms = 0.0;
+    double onboard_wait_ms = 0.0;
+    // The platform slot granted at the stop the train is heading to or standing at.
+    unsigned long long request_seq = 0;
+    long long dock_ms = 0;
+    long long depart_ms = 0;
+    long long next_arrival_ms = -1;
+};
+
+struct PlatformRequest {
+    long long time_ms;
+    int line;
+    unsigned long long seq;
+    long long dwell_ms;
+    int next_station;
+};
+
+struct LaterRequest {
+    bool operator()(const PlatformRequest& a, const PlatformRequest& b) const {
+        if (a.time_ms != b.time_ms) return a.time_ms > b.time_ms;
+        if (a.line != b.line) return a.line > b.line;
+        return a.seq > b.seq;
+    }
+};
+
+// One replica of a station platform. Every line calling at the station sees
+// the same requests and grants them in (time, line, seq) order, one train at
+// a time, so all replicas agree without talking to each other. A train also
+// holds the platform until the train ahead of it on the same track has
+// reached the next station.
+struct PlatformReplica {
+    std::priority_queue<PlatformRequest, std::vector<PlatformRequest>, LaterRequest> pending;
+    long long free_at = 0;
+    std::vector<std::pair<int, long long>> track_clear_at; // by next station
+
+    long long& clear_at(int next_station) {
+        for (auto& track : track_clear_at) {
+            if (track.first == next_station) return track.second;
+        }
+        track_clear_at.emplace_back(next_station, 0);
+        return track_clear_at.back().second;
+    }
+};
+
+struct InterchangeLink {
+    int partition;
+    int stop;
+};
+
+// Reusable barrier for the window loop (std::barrier needs C++20).
+class WindowBarrier {
+public:
+    explicit WindowBarrier(size_t count) : count_(count), waiting_(0), generation_(0) {}
+
+    // The last thread to arrive runs on_release before anyone moves on.
+    void arrive_and_wait(const std::function<void()>& on_release) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        size_t generation = generation_;
+        if (++waiting_ == count_) {
+            on_release();
+            waiting_ = 0;
+            ++generation_;
+            cv_.notify_all();
+        } else {
+            cv_.wait(lock, [&] { return generation != generation_; });
+        }
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    size_t count_;
+    size_t waiting_;
+    size_t generation_;
+};
+
+unsigned long long fnv_mix(unsigned long long hash, long long value) {
+    for (int i = 0; i < 8; ++i) {
+        hash ^= static_cast<unsigned long long>(value >> (i * 8)) & 0xffULL;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+} // namespace
+
+struct EventSimulation::Partition {
+    int index;
+    std::string line;
+    std::vector<int> stops; // station IDs
+    std::vector<double> segment_km;
+    std::vector<std::vector<InterchangeLink>> interchanges;
+    std::vector<PlatformReplica> platforms;
+    std::vector<std::array<long long, 2>> last_departure; // per stop, by direction
+    int hub_index;
+    bool remote = false;
+    std::vector<TrainState> trains;
+    SegmentBatch segments;
+
+    std::priority_queue<Event, std::vector<Event>, LaterEvent> queue;
+    unsigned long long next_seq = 0;
+    Mailbox<LineMessage> inbox;
+    std::vector<LineMessage> incoming;
+
+    SystemMonitor monitor;
+    LineKpis kpis;
+    LineResult result;
+
+    void schedule(long long time_ms, EventKind kind, int train, int stop, int riders = 0) {
+        queue.push(Event{time_ms, index, next_seq++, kind, train, stop, riders});
+    }
+};
+
+EventSimulation::EventSimulation(const TransitNetwork& network, const Config& config)
+    : network_(network), config_(config), queues_(network, DemandProfile(), config.start_of_day_ms), next_train_id_(1),
+      prepared_(false) {
+    config_.transfer_walk_ms = std::max(1LL, config_.transfer_walk_ms);
+    window_ms_ = config_.transfer_walk_ms;
+
+    for (int line = 0; line < network_.route_count(); ++line) {
+        const auto& route = network_.route(line);
+        auto partition = std::unique_ptr<Partition>(new Partition());
+        partition->index = line;
+        partition->line = std::string(route.name);
+        partition->hub_index = 0;
+        for (int i = 0; i < route.stop_count; ++i) {
+            int station = route.stop(i);
+            partition->stops.push_back(station);
+            if (station == route.hub) partition->hub_index = i;
+            if (i + 1 < route.stop_count) {
+                partition->segment_km.push_back(network_.distance_between(station, route.stop(i + 1)));
+                window_ms_ = std::min(window_ms_, travel_ms(station, route.stop(i + 1)));
+            }
+        }
+        partition->interchanges.resize(partition->stops.size());
+        partition->platforms.resize(partition->stops.size());
+        partition->last_departure.assign(partition->stops.size(), std::array<long long, 2>{{-1, -1}});
+        partition->kpis = LineKpis(network_, line);
+        partition->result.line = partition->line;
+        partition->result.digest = kFnvBasis;
+        partitions_.push_back(std::move(partition));
+    }
+}
+
+EventSimulation::~EventSimulation() {}
+
+// A line without trains never claims a platform, so it keeps no replica and
+// riders do not walk over to it.
+void EventSimulation::link_interchanges() {
+    for (auto& from : partitions_) {
+        for (size_t i = 0; i < from->stops.size(); ++i) {
+            for (auto& to : partitions_) {
+                if (to == from || to->trains.empty()) continue;
+                auto it = std::find(to->stops.begin(), to->stops.end(), from->stops[i]);
+                if (it != to->stops.end()) {
+                    from->interchanges[i].push_back({to->index, static_cast<int>(it - to->stops.begin())});
+                }
+            }
+        }
+    }
+}
+
+void EventSimulation::add_trains(const std::string& line, int count) {
+    for (auto& partition : partitions_) {
+        if (partition->line != line) continue;
+        int last_stop = static_cast<int>(partition->stops.size()) - 1;
+        for (int i = 0; i < count; ++i) {
+            // Same placement rule as the real-time mode: hubs first, otherwise alternate ends.
+            bool is_forward = (i % 2 == 0);
+            int stop = partition->hub_index != 0 ? partition->hub_index : (is_forward ? 0 : last_stop);
+            int direction = is_forward ? 1 : -1;
+            if (stop + direction < 0 || stop + direction > last_stop) direction = -direction;
+
+            int train_id = next_train_id_++;
+            std::seed_seq seed{config_.seed, static_cast<unsigned>(train_id)};
+            partition->trains.push_back(TrainState{train_id, stop, direction, 0, 500, std::mt19937(seed)});
+            partition->schedule(0, EventKind::Arrive, static_cast<int>(partition->trains.size()) - 1, stop);
+        }
+        return;
+    }
+}
+
+void EventSimulation::prepare() {
+    if (prepared_) return;
+    prepared_ = true;
+    link_interchanges();
+    for (auto& partition : partitions_) {
+        for (size_t train = 0; train < partition->trains.size(); ++train) {
+            request_platform(*partition, static_cast<int>(train), partition->trains[train].stop, 0);
+        }
+    }
+}
+
+size_t EventSimulation::pending_platform_requests() const {
+    size_t pending = 0;
+    for (const auto& partition : partitions_) {
+        for (const auto& platform : partition->platforms) {
+            pending += platform.pending.size();
+        }
+    }
+    return pending;
+}
+
+void EventSimulation::deliver_mail(Partition& partition) {
+    partition.incoming.clear();
+    partition.inbox.collect(partition.incoming);
+    for (const auto& message : partition.incoming) {
+        if (message.kind == LineMessage::Platform) {
+            partition.platforms[message.stop].pending.push(PlatformRequest{
+                message.time_ms, message.source_line, message.seq, message.dwell_ms, message.next_station});
+        } else {
+            partition.queue.push(Event{message.time_ms, message.source_line, message.seq,
+                                       EventKind::Transfer, -1, message.stop, message.riders});
+        }
+    }
+}
+
+void EventSimulation::run_window(Partition& partition, long long window_end) {
+    while (!partition.queue.empty() && partition.queue.top().time_ms < window_end) {
+        Event event = partition.queue.top();
+        partition.queue.pop();
+
+        auto& result = partition.result;
+        result.events++;
+        result.digest = fnv_mix(result.digest, event.time_ms);
+        result.digest = fnv_mix(result.digest, static_cast<long long>(event.kind) << 48 |
+                                               static_cast<long long>(event.train + 1) << 24 | event.stop);
+
+        switch (event.kind) {
+        case EventKind::Arrive:
+            handle_arrival(partition, event.train, event.time_ms);
+            break;
+        case EventKind::Dock:
+            handle_dock(partition, event.train, event.time_ms);
+            break;
+        case EventKind::Depart:
+            handle_departure(partition, event.train, event.time_ms);
+            break;
+        case EventKind::Transfer:
+            queues_.add_waiting(partition.index, partition.stops[event.stop],
+                                config_.start_of_day_ms + event.time_ms, event.riders);
+            result.transfers_in += event.riders;
+            break;
+        }
+    }
+}
+
+// Every request for this platform up to the train's own was announced at
+// least one run ahead, so the replica can grant them all now.
+void EventSimulation::claim_platform(Partition& partition, int train_index, int stop) {
+    auto& train = partition.trains[train_index];
+    auto& platform = partition.platforms[stop];
+    while (!platform.pending.empty()) {
+        PlatformRequest request = platform.pending.top();
+        platform.pending.pop();
+
+        long long dock_ms = std::max(request.time_ms, platform.free_at);
+        long long depart_ms = dock_ms + request.dwell_ms;
+        long long next_arrival_ms = -1;
+        if (request.next_station >= 0) {
+            long long& clear_at = platform.clear_at(request.next_station);
+            depart_ms = std::max(depart_ms, clear_at);
+            next_arrival_ms = depart_ms + travel_ms(partition.stops[stop], request.next_station);
+            clear_at = next_arrival_ms;
+        }
+        platform.free_at = depart_ms;
+
+        if (request.line == partition.index && request.seq == train.request_seq) {
+            train.dock_ms = dock_ms;
+            train.depart_ms = depart_ms;
+            train.next_arrival_ms = next_arrival_ms;
+            return;
+        }
+    }
+}
+
+// Asks every line calling at the stop for its platform, with the dwell the
+// train will take there and where it heads next.
+void EventSimulation::request_platform(Partition& partition, int train_index, int stop, long long time_ms) {
+    auto& train = partition.trains[train_index];
+    std::uniform_int_distribution<> dwell_rng(20, 40);
+    long long dwell_ms = dwell_rng(train.rng) * 1000LL;
+
+    int last_stop = static_cast<int>(partition.stops.size()) - 1;
+    int next_station = -1;
+    if (last_stop > 0) {
+        int next_stop = stop + train.direction;
+        if (next_stop < 0 || next_stop > last_stop) next_stop = stop - train.direction;
+        next_station = partition.stops[next_stop];
+    }
+
+    train.request_seq = partition.next_seq++;
+    partition.platforms[stop].pending.push(
+        PlatformRequest{time_ms, partition.index, train.request_seq, dwell_ms, next_station});
+    for (const auto& link : partition.interchanges[stop]) {
+        LineMessage message = LineMessage();
+        message.kind = LineMessage::Platform;
+        message.time_ms = time_ms;
+        message.source_line = partition.index;
+        message.seq = train.request_seq;
+        message.stop = link.stop;
+        message.dwell_ms = dwell_ms;
+        message.next_station = next_station;
+        post_message(link.partition, message);
+    }
+}
+
+void EventSimulation::handle_arrival(Partition& partition, int train_index, long long now) {
+    auto& train = partition.trains[train_index];
+    claim_platform(partition, train_index, train.stop);
+    // One train per platform: wait on the approach until it is free.
+    partition.schedule(std::max(now, train.dock_ms), EventKind::Dock, train_index, train.stop);
+}
+
+void EventSimulation::handle_dock(Partition& partition, int train_index, long long now) {
+    auto& train = partition.trains[train_index];
+    int stop = train.stop;
+
+    // Riders are bound for any of the stops still ahead, this one included.
+    int last_stop = static_cast<int>(partition.stops.size()) - 1;
+    int stops_ahead = train.direction > 0 ? last_stop - stop : stop;
+    int riders_off = train.riders / (stops_ahead + 1);
+
+    const auto& links = partition.interchanges[stop];
+    if (!links.empty()) {
+        int transferring = riders_off * kTransferPercent / 100;
+        int share = transferring / static_cast<int>(links.size());
+        for (size_t i = 0; i < links.size() && share > 0; ++i) {
+            LineMessage message = LineMessage();
+            message.kind = LineMessage::Transfer;
+            message.time_ms = now + config_.transfer_walk_ms;
+            message.source_line = partition.index;
+            message.seq = partition.next_seq++;
+            message.stop = links[i].stop;
+            message.riders = share;
+            post_message(links[i].partition, message);
+            partition.result.transfers_out += share;
+        }
+    }
+
+    int space = train.max_riders - (train.riders - riders_off);
+    auto boarding = queues_.board(partition.index, partition.stops[stop], config_.start_of_day_ms + now, space);
+    int riders_on = boarding.boarded;
+
+    partition.monitor.record_passengers(riders_on, riders_off);
+    if (boarding.denied > 0) partition.monitor.record_denied(boarding.denied);
+
+    auto& kpis = partition.kpis;
+    if (riders_off > 0) {
+        // Journey time of this line's leg: platform wait plus time on board.
+        double since = train.onboard_since_ms / train.riders;
+        double waited = train.onboard_wait_ms / train.riders;
+        kpis.record(Kpi::Journey, stop, static_cast<unsigned long long>(now - since + waited), riders_off);
+        train.onboard_since_ms -= since * riders_off;
+        train.onboard_wait_ms -= waited * riders_off;
+    }
+    if (riders_on > 0) {
+        kpis.record(Kpi::Wait, stop, static_cast<unsigned long long>(boarding.mean_wait_ms), riders_on);
+        train.onboard_since_ms += static_cast<double>(now) * riders_on;
+        train.onboard_wait_ms += boarding.mean_wait_ms * riders_on;
+    }
+    train.riders = train.riders - riders_off + riders_on;
+    partition.result.arrivals++;
+
+    // The departure was fixed with the platform grant, so its KPIs are recorded now.
+    if (stop + train.direction < 0 || stop + train.direction > last_stop) train.direction = -train.direction;
+    long long& last = partition.last_departure[stop][train.direction > 0 ? 1 : 0];
+    if (last >= 0) kpis.record(Kpi::Headway, stop, static_cast<unsigned long long>(train.depart_ms - last));
+    last = train.depart_ms;
+    kpis.record(Kpi::Dwell, stop, static_cast<unsigned long long>(train.depart_ms - now));
+    kpis.record(Kpi::LoadFactor, stop, static_cast<unsigned long long>(train.riders * 100 / train.max_riders));
+
+    if (last_stop == 0) return;
+    partition.schedule(train.depart_ms, EventKind::Depart, train_index, stop);
+    request_platform(partition, train_index, stop + train.direction, train.next_arrival_ms);
+}
+
+void EventSimulation::handle_departure(Partition& partition, int train_index, long long now) {
+    auto& train = partition.trains[train_index];
+    int next_stop = train.stop + train.direction;
+
+    double distance = partition.segment_km[std::min(train.stop, next_stop)];
+    if (distance <= 0) distance = 1.0;
+    partition.segments.add(distance, train.riders);
+    if (partition.segments.full()) charge_energy(partition);
+
+    std::uniform_real_distribution<> fault_rng(0.0, 1.0);
+    if (fault_rng(train.rng) < 0.01) {
+        partition.monitor.log_incident_cost(kFaultCost);
+    }
+
+    train.stop = next_stop;
+    partition.schedule(std::max(now, train.next_arrival_ms), EventKind::Arrive, train_index, next_stop);
+}
+
+long long EventSimulation::travel_ms(int from_station, int to_station) const {
+    double distance = network_.distance_between(from_station, to_station);
+    if (distance <= 0) distance = 1.0;
+    return static_cast<long long>(distance / kSpeedKmh * kMsPerHour);
+}
+
+void EventSimulation::post_message(int line, const LineMessage& message) {
+    if (partitions_[line]->remote) {
+        remote_outbox_.emplace_back(line, message);
+    } else {
+        partitions_[line]->inbox.post(message);
+    }
+}
+
+// Costs the segments the line drove since the last charge as one batch.
+void EventSimulation::charge_energy(Partition& partition) {
+    if (partition.segments.empty()) return;
+    double kwh = traction_.total_kwh(partition.segments);
+    partition.monitor.log_energy_use(kwh, traction_.cost(kwh));
+    partition.segments.clear();
+}
+
+void EventSimulation::finish_partition(Partition& partition) {
+    charge_energy(partition);
+}
+
+int EventSimulation::window_count() const {
+    return static_cast<int>((config_.duration_ms + window_ms_ - 1) / window_ms_);
+}
+
+long long EventSimulation::window_end(int window) const {
+    return std::min((window + 1) * window_ms_, config_.duration_ms);
+}
+
+// The final state is reported by the caller, so the last window never snapshots.
+bool EventSimulation::snapshot_due(int window) const {
+    if (config_.kpi_every_ms <= 0) return false;
+    long long end = window_end(window);
+    long long start = window * window_ms_;
+    return end < config_.duration_ms && end / config_.kpi_every_ms > start / config_.kpi_every_ms;
+}
+
+void EventSimulation::emit_snapshot(int window) {
+    if (snapshot_handler_) snapshot_handler_(window_end(window));
+}
+
+void EventSimulation::run_sequential() {
+    for (int window = 0; window < window_count(); ++window) {
+        for (auto& partition : partitions_) {
+            deliver_mail(*partition);
+            run_window(*partition, window_end(window));
+        }
+        if (snapshot_due(window)) emit_snapshot(window);
+    }
+}
+
+void EventSimulation::run_parallel() {
+    WindowBarrier barrier(partitions_.size());
+    std::vector<std::thread> workers;
+    for (auto& partition : partitions_) {
+        Partition* owned = partition.get();
+        workers.emplace_back([this, owned, &barrier] {
+            for (int window = 0; window < window_count(); ++window) {
+                deliver_mail(*owned);
+                run_window(*owned, window_end(window));
+                barrier.arrive_and_wait([this, window] {
+                    if (snapshot_due(window)) emit_snapshot(window);
+                });
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void EventSimulation::run() {
+    prepare();
+    if (config_.parallel && partitions_.size() > 1) {
+        run_parallel();
+    } else {
+        run_sequential();
+    }
+
+    for (auto& partition : partitions_) {
+        finish_partition(*partition);
+    }
+}
+
+bool EventSimulation::run_shard(int shard, int shard_count, ShardTransport& transport) {
+    for (auto& partition : partitions_) {
+        partition->remote = shard_of(partition->index, shard_count) != shard;
+    }
+
+    ShardMessage message;
+    for (int window = 0; window < window_count(); ++window) {
+        for (auto& partition : partitions_) {
+            if (partition->remote) continue;
+            deliver_mail(*partition);
+            run_window(*partition, window_end(window));
+            if (snapshot_due(window) && !send_kpis(*partition, transport)) return false;
+        }
+
+        for (const auto& outgoing : remote_outbox_) {
+            if (!transport.send(ShardMessage::handoff_to(outgoing.first, outgoing.second))) return false;
+        }
+        remote_outbox_.clear();
+        if (!transport.send(ShardMessage::control(ShardMessage::WindowDone, window))) return false;
+
+        // Hold until the coordinator has routed everyone's hand-offs for this window.
+        while (true) {
+            if (!transport.receive(message)) return false;
+            if (message.kind == ShardMessage::WindowGo) break;
+            if (message.kind == ShardMessage::Handoff) {
+                partitions_[message.line]->inbox.post(message.handoff);
+            }
+        }
+    }
+
+    for (auto& partition : partitions_) {
+        if (partition->remote) continue;
+        finish_partition(*partition);
+        if (!send_kpis(*partition, transport)) return false;
+        if (!transport.send(ShardMessage::line_totals(partition->index, line_totals(partition->index)))) return false;
+    }
+    return transport.send(ShardMessage::control(ShardMessage::Finished, window_count()));
+}
+
+// Ships what the partition recorded since the last call; the coordinator adds it up.
+bool EventSimulation::send_kpis(Partition& partition, ShardTransport& transport) {
+    std::vector<KpiChunk> chunks;
+    partition.kpis.append_chunks(chunks);
+    for (const auto& chunk : chunks) {
+        if (!transport.send(ShardMessage::kpi_chunk(partition.index, chunk))) return false;
+    }
+    partition.kpis.clear();
+    return true;
+}
+
+void EventSimulation::absorb_kpi_chunk(int line, const KpiChunk& chunk) {
+    partitions_[line]->kpis.absorb(chunk);
+}
+
+std::vector<const LineKpis*> EventSimulation::line_kpis() const {
+    std::vector<const LineKpis*> out;
+    for (const auto& partition : partitions_) {
+        out.push_back(&partition->kpis);
+    }
+    return out;
+}
+
+LineTotals EventSimulation::line_totals(int line) const {
+    const auto& partition = *partitions_[line];
+    LineTotals totals;
+    totals.events = partition.result.events;
+    totals.arrivals = partition.result.arrivals;
+    totals.transfers_in = partition.result.transfers_in;
+    totals.transfers_out = partition.result.transfers_out;
+    totals.digest = partition.result.digest;
+    totals.riders = partition.monitor.total_riders();
+    totals.alighted = partition.monitor.total_alighted();
+    totals.denied = partition.monitor.denied_boardings();
+    totals.energy_expense = partition.monitor.energy_expense();
+    totals.energy_kwh = partition.monitor.energy_kwh();
+    totals.incident_expense = partition.monitor.incident_expense();
+    return totals;
+}
+
+void EventSimulation::absorb_line_totals(int line, const LineTotals& totals) {
+    auto& partition = *partitions_[line];
+    partition.result.events = totals.events;
+    partition.result.arrivals = totals.arrivals;
+    partition.result.transfers_in = totals.transfers_in;
+    partition.result.transfers_out = totals.transfers_out;
+    partition.result.digest = totals.digest;
+    partition.monitor.record_passengers(totals.riders, totals.alighted);
+    partition.monitor.record_denied(totals.denied);
+    partition.monitor.log_energy_use(totals.energy_kwh, totals.energy_expense);
+    partition.monitor.log_incident_cost(totals.incident_expense);
+}
+
+std::vector<EventSimulation::LineResult> EventSimulation::results() const {
+    std::vector<LineResult> out;
+    for (const auto& partition : partitions_) {
+        out.push_back(partition->result);
+    }
+    return out;
+}
+
+unsigned long long EventSimulation::digest() const {
+    unsigned long long hash = kFnvBasis;
+    for (const auto& partition : partitions_) {
+        hash = fnv_mix(hash, static_cast<long long>(partition->result.digest));
+    }
+    return hash;
+}
+
+void EventSimulation::merge_into(SystemMonitor& monitor) const {
+    for (const auto& partition : partitions_) {
+        monitor.merge(partition->monitor);
+    }
+}
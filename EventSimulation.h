@@ -0,0 +1,145 @@
+#ifndef EVENT_SIMULATION_H
+#define EVENT_SIMULATION_H
+
+#include "TransitNetwork.h"
+#include "SystemMonitor.h"
+#include "TractionModel.h"
+#include "StationDemand.h"
+#include "KpiHistogram.h"
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Everything that crosses partition boundaries. Lines share platforms and the
+// track between them (Red and Green run together from 28 May to Azi
+// Aslanov), so a train of one line asks every line calling at its next
+// station for the platform; each of them keeps a replica of the platform and
+// grants it in the same order. Passengers walking to another line at an
+// interchange are an addition of this mode, the real-time trains do not
+// transfer riders.
+struct LineMessage {
+    enum Kind : int { Transfer, Platform };
+
+    int kind;
+    long long time_ms;
+    int source_line;
+    unsigned long long seq;
+    int stop;            // stop index on the receiving line
+    int riders;          // Transfer
+    long long dwell_ms;  // Platform: planned dwell at this stop
+    int next_station;    // Platform: where the train heads afterwards, -1 for nowhere
+};
+
+// Plain per-line totals, so worker processes can ship them to the coordinator.
+struct LineTotals {
+    long long events;
+    long long arrivals;
+    long long transfers_in;
+    long long transfers_out;
+    unsigned long long digest;
+    long long riders;
+    long long alighted;
+    long long denied;
+    double energy_expense;
+    double energy_kwh;
+    double incident_expense;
+};
+
+class ShardTransport;
+
+// Discrete-event simulation partitioned by line. Every line owns its own event
+// queue and, in parallel mode, its own thread. A train asks for its next
+// platform when it docks at the current one, at least one inter-station run
+// ahead, so partitions advance in conservative time windows no longer than
+// the shortest run (or the transfer walk, if shorter) and nothing a partition
+// sends can land inside the window the receiver is processing.
+class EventSimulation {
+public:
+    struct Config {
+        unsigned seed = 2025;
+        long long duration_ms = 20LL * 3600 * 1000;
+        long long start_of_day_ms = 6LL * 3600 * 1000;
+        long long transfer_walk_ms = 90 * 1000;
+        bool parallel = false;
+        long long kpi_every_ms = 0; // periodic KPI snapshots, 0 = none
+    };
+
+    struct LineResult {
+        std::string line;
+        long long events = 0;
+        long long arrivals = 0;
+        long long transfers_in = 0;
+        long long transfers_out = 0;
+        unsigned long long digest = 0;
+    };
+
+    EventSimulation(const TransitNetwork& network, const Config& config);
+    ~EventSimulation();
+    EventSimulation(const EventSimulation&) = delete;
+    EventSimulation& operator=(const EventSimulation&) = delete;
+
+    void add_trains(const std::string& line, int count);
+    // Links the lines that have trains and files every train's first
+    // platform request. run() does it itself; sharded runs must do it
+    // before forking so every worker starts from the same requests.
+    void prepare();
+    void run();
+    // Platform requests filed but not granted yet, over every replica.
+    size_t pending_platform_requests() const;
+
+    // Sharded mode: a worker process runs only the lines it owns and swaps
+    // boundary messages with the coordinator once per window.
+    int line_count() const { return static_cast<int>(partitions_.size()); }
+    int window_count() const;
+    static int shard_of(int line, int shard_count) { return line % shard_count; }
+    bool run_shard(int shard, int shard_count, ShardTransport& transport);
+    LineTotals line_totals(int line) const;
+    void absorb_line_totals(int line, const LineTotals& totals);
+
+    // KPI histograms keep accumulating for the whole run. The snapshot
+    // handler runs between windows, with every line paused, each time
+    // kpi_every_ms of simulated time has passed.
+    void set_snapshot_handler(std::function<void(long long elapsed_ms)> handler) { snapshot_handler_ = std::move(handler); }
+    std::vector<const LineKpis*> line_kpis() const;
+    bool snapshot_due(int window) const;
+    void emit_snapshot(int window);
+    void absorb_kpi_chunk(int line, const KpiChunk& chunk);
+
+    std::vector<LineResult> results() const;
+    unsigned long long digest() const;
+    void merge_into(SystemMonitor& monitor) const;
+
+private:
+    struct Partition;
+
+    void link_interchanges();
+    void deliver_mail(Partition& partition);
+    void run_window(Partition& partition, long long window_end);
+    void handle_arrival(Partition& partition, int train, long long now);
+    void handle_dock(Partition& partition, int train, long long now);
+    void handle_departure(Partition& partition, int train, long long now);
+    void request_platform(Partition& partition, int train, int stop, long long time_ms);
+    void claim_platform(Partition& partition, int train, int stop);
+    long long travel_ms(int from_station, int to_station) const;
+    void post_message(int line, const LineMessage& message);
+    void charge_energy(Partition& partition);
+    void finish_partition(Partition& partition);
+    long long window_end(int window) const;
+    bool send_kpis(Partition& partition, ShardTransport& transport);
+    void run_sequential();
+    void run_parallel();
+
+    const TransitNetwork& network_;
+    Config config_;
+    TractionModel traction_;
+    StationQueues queues_;
+    int next_train_id_;
+    std::vector<std::unique_ptr<Partition>> partitions_;
+    bool prepared_;
+    long long window_ms_;
+    std::vector<std::pair<int, LineMessage>> remote_outbox_;
+    std::function<void(long long)> snapshot_handler_;
+};
+
+#endif // EVENT_SIMULATION_H
@@ -0,0 +1,126 @@
+#include "KpiExport.h"
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+template <typename T>
+void write_value(std::ofstream& out, T value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+void write_column(std::ofstream& out, const std::vector<T>& column) {
+    if (!column.empty()) out.write(reinterpret_cast<const char*>(column.data()), column.size() * sizeof(T));
+}
+
+const Kpi kAllKpis[kKpiCount] = {Kpi::LoadFactor, Kpi::Dwell, Kpi::Headway, Kpi::Wait, Kpi::Journey};
+
+} // namespace
+
+KpiExporter::KpiExporter(const TransitNetwork& network, const std::string& prefix)
+    : network_(network), csv_(prefix + ".csv"), binary_(prefix + ".kpi", std::ios::binary), ok_(true) {
+    if (!csv_ || !binary_) {
+        ok_ = false;
+        error_ = "could not open " + prefix + ".csv / " + prefix + ".kpi for writing";
+        return;
+    }
+    csv_ << "elapsed_ms,line,station,kpi,unit,count,min,mean,p50,p90,p99,max\n";
+    binary_.write("SKPI", 4);
+    write_value<std::uint32_t>(binary_, 1);
+    write_value<std::uint32_t>(binary_, KpiHistogram::kSubBucketBits);
+    write_value<std::uint32_t>(binary_, KpiHistogram::kBucketCount);
+}
+
+void KpiExporter::write_csv_row(long long elapsed_ms, int line, int station, Kpi kpi, const KpiHistogram& histogram) {
+    csv_ << elapsed_ms << ',' << network_.route(line).name << ','
+         << (station >= 0 ? network_.station_name(station) : std::string_view()) << ','
+         << kpi_name(kpi) << ',' << kpi_unit(kpi) << ',' << histogram.count() << ',' << histogram.min() << ','
+         << std::fixed << std::setprecision(1) << histogram.mean() << ',' << histogram.percentile(50) << ','
+         << histogram.percentile(90) << ',' << histogram.percentile(99) << ',' << histogram.max() << '\n';
+}
+
+void KpiExporter::write_snapshot(long long elapsed_ms, const std::vector<const LineKpis*>& lines) {
+    if (!ok_) return;
+
+    std::vector<std::int8_t> series_line, series_station;
+    std::vector<std::uint8_t> series_kpi;
+    std::vector<std::uint64_t> series_count;
+    std::vector<std::uint64_t> series_min, series_max;
+    std::vector<std::uint16_t> bucket_series;
+    std::vector<std::uint16_t> bucket_index;
+    std::vector<std::uint64_t> bucket_count;
+
+    for (const LineKpis* kpis : lines) {
+        for (Kpi kpi : kAllKpis) {
+            KpiHistogram total = kpis->line_total(kpi);
+            if (total.empty()) continue;
+            write_csv_row(elapsed_ms, kpis->line(), -1, kpi, total);
+
+            for (int stop = 0; stop < kpis->stop_count(); ++stop) {
+                const KpiHistogram& histogram = kpis->series(kpi, stop);
+                if (histogram.empty()) continue;
+                write_csv_row(elapsed_ms, kpis->line(), kpis->station(stop), kpi, histogram);
+
+                auto row = static_cast<std::uint16_t>(series_count.size());
+                series_line.push_back(static_cast<std::int8_t>(kpis->line()));
+                series_station.push_back(static_cast<std::int8_t>(kpis->station(stop)));
+                series_kpi.push_back(static_cast<std::uint8_t>(kpi));
+                series_count.push_back(histogram.count());
+                series_min.push_back(histogram.min());
+                series_max.push_back(histogram.max());
+                for (int b = 0; b < KpiHistogram::kBucketCount; ++b) {
+                    if (histogram.bucket(b) == 0) continue;
+                    bucket_series.push_back(row);
+                    bucket_index.push_back(static_cast<std::uint16_t>(b));
+                    bucket_count.push_back(histogram.bucket(b));
+                }
+            }
+        }
+    }
+
+    binary_.write("SNAP", 4);
+    write_value<std::int64_t>(binary_, elapsed_ms);
+    write_value<std::uint32_t>(binary_, static_cast<std::uint32_t>(series_count.size()));
+    write_value<std::uint32_t>(binary_, static_cast<std::uint32_t>(bucket_count.size()));
+    write_column(binary_, series_line);
+    write_column(binary_, series_station);
+    write_column(binary_, series_kpi);
+    write_column(binary_, series_count);
+    write_column(binary_, series_min);
+    write_column(binary_, series_max);
+    write_column(binary_, bucket_series);
+    write_column(binary_, bucket_index);
+    write_column(binary_, bucket_count);
+
+    csv_.flush();
+    binary_.flush();
+    if (!csv_ || !binary_) {
+        ok_ = false;
+        error_ = "write failed";
+    }
+}
+
+void print_kpi_summary(const TransitNetwork& network, const std::vector<const LineKpis*>& lines) {
+    for (const LineKpis* kpis : lines) {
+        KpiHistogram load = kpis->line_total(Kpi::LoadFactor);
+        if (load.empty()) continue;
+        KpiHistogram headway = kpis->line_total(Kpi::Headway);
+        KpiHistogram wait = kpis->line_total(Kpi::Wait);
+        KpiHistogram journey = kpis->line_total(Kpi::Journey);
+        // Formatted locally so std::cout keeps its own flags.
+        std::ostringstream out;
+        out << "📊 " << network.route(kpis->line()).name << ": load p50 " << load.percentile(50) << "% p99 "
+            << load.percentile(99) << "%, dwell p50 " << kpis->line_total(Kpi::Dwell).percentile(50) / 1000 << " s, ";
+        if (headway.empty()) {
+            out << "headway n/a";
+        } else {
+            out << "headway p50 " << headway.percentile(50) / 1000 << " s p99 " << headway.percentile(99) / 1000 << " s";
+        }
+        out << ", wait mean " << std::fixed << std::setprecision(0) << wait.mean() / 1000.0
+            << " s, journey p50 " << journey.percentile(50) / 1000 << " s\n";
+        std::cout << out.str();
+    }
+}
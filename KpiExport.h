@@ -0,0 +1,41 @@
+#ifndef KPI_EXPORT_H
+#define KPI_EXPORT_H
+
+#include "KpiHistogram.h"
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Writes KPI snapshots to <prefix>.csv and <prefix>.kpi, one snapshot per
+// call, appended so periodic and final snapshots share a file.
+//
+// The CSV has one summary row per line and per line platform.
+// The .kpi file is columnar, native byte order:
+//   header   "SKPI", u32 version (1), u32 sub-bucket bits, u32 bucket count
+//   snapshot "SNAP", i64 elapsed ms, u32 series rows n, u32 bucket rows m,
+//            i8 line[n], i8 station[n], u8 kpi[n], u64 count[n],
+//            u64 min[n], u64 max[n] (exact),
+//            u16 series[m], u16 bucket[m], u64 count[m]
+// Only platform series are stored; a line is the sum of its platforms, and
+// bucket rows reference series by their row in the same snapshot.
+class KpiExporter {
+public:
+    KpiExporter(const TransitNetwork& network, const std::string& prefix);
+
+    bool ok() const { return ok_; }
+    const std::string& error() const { return error_; }
+    void write_snapshot(long long elapsed_ms, const std::vector<const LineKpis*>& lines);
+
+private:
+    void write_csv_row(long long elapsed_ms, int line, int station, Kpi kpi, const KpiHistogram& histogram);
+
+    const TransitNetwork& network_;
+    std::ofstream csv_;
+    std::ofstream binary_;
+    bool ok_;
+    std::string error_;
+};
+
+void print_kpi_summary(const TransitNetwork& network, const std::vector<const LineKpis*>& lines);
+
+#endif // KPI_EXPORT_H
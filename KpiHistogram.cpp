@@ -0,0 +1,181 @@
+#include "KpiHistogram.h"
+#include <algorithm>
+
+namespace {
+
+const unsigned long long kMaxValue = (1ULL << (KpiHistogram::kMaxShift + KpiHistogram::kSubBucketBits + 1)) - 1;
+
+} // namespace
+
+int KpiHistogram::bucket_of(unsigned long long value) {
+    if (value < static_cast<unsigned long long>(kSubBuckets)) return static_cast<int>(value);
+    value = std::min(value, kMaxValue);
+    int shift = 0;
+    while ((value >> shift) >= 2ULL * kSubBuckets) ++shift;
+    return shift * kSubBuckets + static_cast<int>(value >> shift);
+}
+
+unsigned long long KpiHistogram::bucket_low(int index) {
+    if (index < 2 * kSubBuckets) return static_cast<unsigned long long>(index);
+    int shift = index / kSubBuckets - 1;
+    return static_cast<unsigned long long>(index % kSubBuckets + kSubBuckets) << shift;
+}
+
+unsigned long long KpiHistogram::bucket_width(int index) {
+    if (index < 2 * kSubBuckets) return 1;
+    return 1ULL << (index / kSubBuckets - 1);
+}
+
+void KpiHistogram::record(unsigned long long value, unsigned long long count) {
+    if (count == 0) return;
+    buckets_[bucket_of(value)] += count;
+    count_ += count;
+    widen(value, value);
+}
+
+void KpiHistogram::add_to_bucket(int index, unsigned long long count) {
+    if (index < 0 || index >= kBucketCount) return;
+    buckets_[index] += count;
+    count_ += count;
+}
+
+void KpiHistogram::widen(unsigned long long min, unsigned long long max) {
+    min_ = std::min(min_, min);
+    max_ = std::max(max_, max);
+}
+
+void KpiHistogram::merge(const KpiHistogram& other) {
+    for (int i = 0; i < kBucketCount; ++i) {
+        buckets_[i] += other.buckets_[i];
+    }
+    count_ += other.count_;
+    if (!other.empty()) widen(other.min_, other.max_);
+}
+
+void KpiHistogram::clear() {
+    buckets_.fill(0);
+    count_ = 0;
+    min_ = ~0ULL;
+    max_ = 0;
+}
+
+// Values inside a bucket are reported as its midpoint.
+double KpiHistogram::mean() const {
+    if (count_ == 0) return 0.0;
+    double sum = 0.0;
+    for (int i = 0; i < kBucketCount; ++i) {
+        if (buckets_[i] == 0) continue;
+        sum += buckets_[i] * (bucket_low(i) + (bucket_width(i) - 1) / 2.0);
+    }
+    return sum / count_;
+}
+
+unsigned long long KpiHistogram::percentile(double percent) const {
+    if (count_ == 0) return 0;
+    unsigned long long rank = static_cast<unsigned long long>(percent / 100.0 * count_ + 0.5);
+    rank = std::max(1ULL, std::min(rank, count_));
+    unsigned long long seen = 0;
+    for (int i = 0; i < kBucketCount; ++i) {
+        seen += buckets_[i];
+        if (seen >= rank) return std::max(min_, std::min(max_, bucket_low(i) + (bucket_width(i) - 1) / 2));
+    }
+    return max_;
+}
+
+const char* kpi_name(Kpi kpi) {
+    switch (kpi) {
+    case Kpi::LoadFactor: return "load_factor";
+    case Kpi::Dwell: return "dwell";
+    case Kpi::Headway: return "headway";
+    case Kpi::Wait: return "passenger_wait";
+    case Kpi::Journey: return "journey_time";
+    }
+    return "";
+}
+
+const char* kpi_unit(Kpi kpi) {
+    return kpi == Kpi::LoadFactor ? "percent" : "ms";
+}
+
+LineKpis::LineKpis(const TransitNetwork& network, int line) : line_(line) {
+    const auto& route = network.route(line);
+    for (int i = 0; i < route.stop_count; ++i) {
+        stations_.push_back(route.stop(i));
+    }
+    series_.resize(kKpiCount * stations_.size());
+}
+
+KpiHistogram LineKpis::line_total(Kpi kpi) const {
+    KpiHistogram total;
+    for (int stop = 0; stop < stop_count(); ++stop) {
+        total.merge(series(kpi, stop));
+    }
+    return total;
+}
+
+void LineKpis::merge(const LineKpis& other) {
+    for (size_t i = 0; i < series_.size() && i < other.series_.size(); ++i) {
+        series_[i].merge(other.series_[i]);
+    }
+}
+
+void LineKpis::clear() {
+    for (auto& histogram : series_) {
+        histogram.clear();
+    }
+}
+
+void LineKpis::append_chunks(std::vector<KpiChunk>& out) const {
+    for (size_t s = 0; s < series_.size(); ++s) {
+        const auto& histogram = series_[s];
+        if (histogram.empty()) continue;
+        KpiChunk chunk = KpiChunk();
+        chunk.series = static_cast<int>(s);
+        chunk.min = histogram.min();
+        chunk.max = histogram.max();
+        for (int b = 0; b < KpiHistogram::kBucketCount; ++b) {
+            if (histogram.bucket(b) == 0) continue;
+            chunk.bucket[chunk.used] = static_cast<unsigned short>(b);
+            chunk.count[chunk.used] = histogram.bucket(b);
+            if (++chunk.used == KpiChunk::kPairs) {
+                out.push_back(chunk);
+                chunk.used = 0;
+            }
+        }
+        if (chunk.used > 0) out.push_back(chunk);
+    }
+}
+
+void LineKpis::absorb(const KpiChunk& chunk) {
+    if (chunk.series < 0 || chunk.series >= static_cast<int>(series_.size())) return;
+    auto& histogram = series_[chunk.series];
+    for (int i = 0; i < chunk.used && i < KpiChunk::kPairs; ++i) {
+        histogram.add_to_bucket(chunk.bucket[i], chunk.count[i]);
+    }
+    histogram.widen(chunk.min, chunk.max);
+}
+
+KpiBoard::KpiBoard(const TransitNetwork& network) {
+    for (int line = 0; line < network.route_count(); ++line) {
+        lines_.emplace_back(network, line);
+        last_departure_.emplace_back(lines_.back().stop_count(), std::array<long long, 2>{{-1, -1}});
+    }
+}
+
+void KpiBoard::record(int line, Kpi kpi, int stop, unsigned long long value, unsigned long long count) {
+    std::lock_guard<std::mutex> lock(lock_);
+    lines_[line].record(kpi, stop, value, count);
+}
+
+long long KpiBoard::departed(int line, int stop, int direction, long long now_ms) {
+    std::lock_guard<std::mutex> lock(lock_);
+    long long& last = last_departure_[line][stop][direction > 0 ? 1 : 0];
+    long long headway = last < 0 ? -1 : now_ms - last;
+    last = now_ms;
+    return headway;
+}
+
+std::vector<LineKpis> KpiBoard::snapshot() const {
+    std::lock_guard<std::mutex> lock(lock_);
+    return lines_;
+}
@@ -0,0 +1,111 @@
+#ifndef KPI_HISTOGRAM_H
+#define KPI_HISTOGRAM_H
+
+#include "TransitNetwork.h"
+#include <array>
+#include <mutex>
+#include <vector>
+
+// Fixed-memory log-linear histogram in the style of HdrHistogram. Values below
+// 64 get a bucket each; above that every power of two is split into 32
+// buckets, so any value is kept within about 3%. Merging is adding buckets,
+// and count, mean and percentiles come from the buckets; min and max are
+// kept exactly, and percentiles never fall outside them.
+class KpiHistogram {
+public:
+    static const int kSubBucketBits = 5;
+    static const int kSubBuckets = 1 << kSubBucketBits;
+    static const int kMaxShift = 27; // values up to 2^33, larger ones are clamped
+    static const int kBucketCount = (kMaxShift + 2) * kSubBuckets;
+
+    void record(unsigned long long value, unsigned long long count = 1);
+    void merge(const KpiHistogram& other);
+    void clear();
+
+    unsigned long long count() const { return count_; }
+    bool empty() const { return count_ == 0; }
+    double mean() const;
+    unsigned long long percentile(double percent) const;
+    unsigned long long min() const { return count_ == 0 ? 0 : min_; }
+    unsigned long long max() const { return max_; }
+
+    unsigned long long bucket(int index) const { return buckets_[index]; }
+    // For rebuilding a histogram from its parts: buckets, then the exact range.
+    void add_to_bucket(int index, unsigned long long count);
+    void widen(unsigned long long min, unsigned long long max);
+    static int bucket_of(unsigned long long value);
+    static unsigned long long bucket_low(int index);
+    static unsigned long long bucket_width(int index);
+
+private:
+    std::array<unsigned long long, kBucketCount> buckets_{};
+    unsigned long long count_ = 0;
+    unsigned long long min_ = ~0ULL;
+    unsigned long long max_ = 0;
+};
+
+enum class Kpi { LoadFactor, Dwell, Headway, Wait, Journey };
+const int kKpiCount = 5;
+const char* kpi_name(Kpi kpi);
+const char* kpi_unit(Kpi kpi); // load factor in percent, times in simulated ms
+
+// Non-empty buckets of one series, small enough to cross the shard rings.
+// Every chunk of a series carries the series' exact min and max.
+struct KpiChunk {
+    static const int kPairs = 24;
+    int series;
+    int used;
+    unsigned long long min;
+    unsigned long long max;
+    unsigned short bucket[kPairs];
+    unsigned long long count[kPairs];
+};
+
+// One histogram per KPI per stop of a line. Line-wide figures are merged from
+// the stops when they are read, so every sample is recorded once.
+class LineKpis {
+public:
+    LineKpis() {}
+    LineKpis(const TransitNetwork& network, int line);
+
+    int line() const { return line_; }
+    int stop_count() const { return static_cast<int>(stations_.size()); }
+    int station(int stop) const { return stations_[stop]; }
+
+    void record(Kpi kpi, int stop, unsigned long long value, unsigned long long count = 1) {
+        series_[index(kpi, stop)].record(value, count);
+    }
+    const KpiHistogram& series(Kpi kpi, int stop) const { return series_[index(kpi, stop)]; }
+    KpiHistogram line_total(Kpi kpi) const;
+
+    void merge(const LineKpis& other);
+    void clear();
+    void append_chunks(std::vector<KpiChunk>& out) const;
+    void absorb(const KpiChunk& chunk);
+
+private:
+    int index(Kpi kpi, int stop) const { return static_cast<int>(kpi) * stop_count() + stop; }
+
+    int line_ = -1;
+    std::vector<int> stations_;
+    std::vector<KpiHistogram> series_;
+};
+
+// KPIs of the real-time trains, which record from many threads.
+class KpiBoard {
+public:
+    explicit KpiBoard(const TransitNetwork& network);
+
+    void record(int line, Kpi kpi, int stop, unsigned long long value, unsigned long long count = 1);
+    // Time since the previous departure from this platform in the same
+    // direction, or -1 for the first one.
+    long long departed(int line, int stop, int direction, long long now_ms);
+    std::vector<LineKpis> snapshot() const;
+
+private:
+    mutable std::mutex lock_;
+    std::vector<LineKpis> lines_;
+    std::vector<std::vector<std::array<long long, 2>>> last_departure_;
+};
+
+#endif // KPI_HISTOGRAM_H
@@ -0,0 +1,50 @@
+#ifndef MAILBOX_H
+#define MAILBOX_H
+
+#include <atomic>
+#include <vector>
+
+// Lock-free multi-producer / single-consumer mailbox.
+// Producers push with a CAS on the head, the owner takes everything at once.
+template <typename T>
+class Mailbox {
+public:
+    Mailbox() : head_(nullptr) {}
+    ~Mailbox() {
+        std::vector<T> dropped;
+        collect(dropped);
+    }
+    Mailbox(const Mailbox&) = delete;
+    Mailbox& operator=(const Mailbox&) = delete;
+
+    void post(const T& value) {
+        Node* node = new Node{value, head_.load(std::memory_order_relaxed)};
+        while (!head_.compare_exchange_weak(node->next, node,
+                                            std::memory_order_release,
+                                            std::memory_order_relaxed)) {
+        }
+    }
+
+    // Appends every pending message to out. Order is not preserved,
+    // receivers sort by their own key.
+    void collect(std::vector<T>& out) {
+        Node* node = head_.exchange(nullptr, std::memory_order_acquire);
+        while (node) {
+            out.push_back(node->value);
+            Node* next = node->next;
+            delete node;
+            node = next;
+        }
+    }
+
+    bool empty() const { return head_.load(std::memory_order_acquire) == nullptr; }
+
+private:
+    struct Node {
+        T value;
+        Node* next;
+    };
+    std::atomic<Node*> head_;
+};
+
+#endif // MAILBOX_H
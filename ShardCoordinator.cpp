@@ -0,0 +1,100 @@
+#include "ShardCoordinator.h"
+#include "SharedMemoryTransport.h"
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <csignal>
+#include <sys/wait.h>
+#include <unistd.h>
+#define SUBWAY_HAS_FORK 1
+#endif
+
+ShardCoordinator::ShardCoordinator(EventSimulation& simulation, int workers)
+    : simulation_(simulation), workers_(std::max(1, std::min(workers, simulation.line_count()))) {}
+
+bool ShardCoordinator::run() {
+#ifndef SUBWAY_HAS_FORK
+    error_ = "sharded mode needs fork() and shared memory";
+    return false;
+#else
+    SharedMemoryChannels channels(workers_);
+    if (!channels.valid()) {
+        error_ = "could not map shared memory for shard rings";
+        return false;
+    }
+
+    // Anything still buffered would otherwise be printed once per worker.
+    std::cout.flush();
+    simulation_.prepare();
+
+    int coordinator_pid = static_cast<int>(getpid());
+    std::vector<int> pids;
+    std::vector<SharedMemoryTransport> links;
+    auto abort_workers = [&](const std::string& reason) {
+        error_ = reason;
+        for (int pid : pids) {
+            kill(pid, SIGKILL);
+            waitpid(pid, nullptr, 0);
+        }
+        return false;
+    };
+
+    for (int worker = 0; worker < workers_; ++worker) {
+        pid_t pid = fork();
+        if (pid < 0) return abort_workers("fork failed");
+        if (pid == 0) {
+            SharedMemoryTransport transport = channels.worker_end(worker, coordinator_pid);
+            bool ok = simulation_.run_shard(worker, workers_, transport);
+            _exit(ok ? 0 : 1);
+        }
+        pids.push_back(static_cast<int>(pid));
+        links.push_back(channels.coordinator_end(worker, static_cast<int>(pid)));
+    }
+
+    ShardMessage message;
+    std::vector<std::vector<ShardMessage>> pending(workers_);
+    for (int window = 0; window < simulation_.window_count(); ++window) {
+        for (int worker = 0; worker < workers_; ++worker) {
+            while (true) {
+                if (!links[worker].receive(message)) return abort_workers("shard worker exited early");
+                if (message.kind == ShardMessage::WindowDone) break;
+                if (message.kind == ShardMessage::Handoff) {
+                    pending[EventSimulation::shard_of(message.line, workers_)].push_back(message);
+                } else if (message.kind == ShardMessage::Kpis) {
+                    simulation_.absorb_kpi_chunk(message.line, message.kpis);
+                }
+            }
+        }
+        if (simulation_.snapshot_due(window)) simulation_.emit_snapshot(window);
+        for (int worker = 0; worker < workers_; ++worker) {
+            for (const auto& handoff : pending[worker]) {
+                if (!links[worker].send(handoff)) return abort_workers("shard worker exited early");
+            }
+            pending[worker].clear();
+            if (!links[worker].send(ShardMessage::control(ShardMessage::WindowGo, window))) {
+                return abort_workers("shard worker exited early");
+            }
+        }
+    }
+
+    for (int worker = 0; worker < workers_; ++worker) {
+        while (true) {
+            if (!links[worker].receive(message)) return abort_workers("shard worker exited before reporting");
+            if (message.kind == ShardMessage::Finished) break;
+            if (message.kind == ShardMessage::Totals) {
+                simulation_.absorb_line_totals(message.line, message.totals);
+            } else if (message.kind == ShardMessage::Kpis) {
+                simulation_.absorb_kpi_chunk(message.line, message.kpis);
+            }
+        }
+    }
+
+    // The transport may already have reaped a worker, so ECHILD is fine here.
+    for (int pid : pids) {
+        waitpid(pid, nullptr, 0);
+    }
+    return true;
+#endif
+}
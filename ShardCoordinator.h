@@ -0,0 +1,23 @@
+#ifndef SHARD_COORDINATOR_H
+#define SHARD_COORDINATOR_H
+
+#include "EventSimulation.h"
+#include <string>
+
+// Runs an EventSimulation across local worker processes. Each worker owns
+// some lines; the coordinator routes boundary messages between them every
+// window and collects per-line totals and KPIs, so results(), digest()
+// and merge_into() on the coordinator's simulation match a single-process run.
+class ShardCoordinator {
+public:
+    ShardCoordinator(EventSimulation& simulation, int workers);
+    bool run();
+    const std::string& error() const { return error_; }
+
+private:
+    EventSimulation& simulation_;
+    int workers_;
+    std::string error_;
+};
+
+#endif // SHARD_COORDINATOR_H
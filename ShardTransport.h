@@ -0,0 +1,57 @@
+#ifndef SHARD_TRANSPORT_H
+#define SHARD_TRANSPORT_H
+
+#include "EventSimulation.h"
+
+// Fixed-size message exchanged between shard workers and the coordinator.
+// Kept trivially copyable so it can sit in shared memory or go over a socket as is.
+struct ShardMessage {
+    enum Kind : int { Handoff, WindowDone, WindowGo, Totals, Finished, Kpis };
+
+    int kind;
+    int line;
+    long long window;
+    LineMessage handoff;
+    LineTotals totals;
+    KpiChunk kpis;
+
+    static ShardMessage control(Kind kind, long long window) {
+        ShardMessage message = ShardMessage();
+        message.kind = kind;
+        message.line = -1;
+        message.window = window;
+        return message;
+    }
+
+    static ShardMessage handoff_to(int line, const LineMessage& handoff) {
+        ShardMessage message = control(Handoff, 0);
+        message.line = line;
+        message.handoff = handoff;
+        return message;
+    }
+
+    static ShardMessage line_totals(int line, const LineTotals& totals) {
+        ShardMessage message = control(Totals, 0);
+        message.line = line;
+        message.totals = totals;
+        return message;
+    }
+
+    static ShardMessage kpi_chunk(int line, const KpiChunk& chunk) {
+        ShardMessage message = control(Kpis, 0);
+        message.line = line;
+        message.kpis = chunk;
+        return message;
+    }
+};
+
+// One end of a worker <-> coordinator link. Both calls block; they return
+// false once the peer is gone.
+class ShardTransport {
+public:
+    virtual ~ShardTransport() {}
+    virtual bool send(const ShardMessage& message) = 0;
+    virtual bool receive(ShardMessage& message) = 0;
+};
+
+#endif // SHARD_TRANSPORT_H
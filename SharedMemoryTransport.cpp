@@ -0,0 +1,100 @@
+#include "SharedMemoryTransport.h"
+#include <chrono>
+#include <new>
+#include <thread>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#define SUBWAY_HAS_SHM 1
+#endif
+
+static_assert(std::atomic<unsigned long long>::is_always_lock_free,
+              "ring indices must be lock-free to be shared between processes");
+
+namespace {
+
+// Spin briefly, then back off so a waiting process does not starve the others.
+void backoff(int attempt) {
+    if (attempt < 64) {
+        std::this_thread::yield();
+    } else {
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+}
+
+} // namespace
+
+SharedMemoryTransport::SharedMemoryTransport(ShmRing* outgoing, ShmRing* incoming, int peer_pid, bool peer_is_parent)
+    : outgoing_(outgoing), incoming_(incoming), peer_pid_(peer_pid), peer_is_parent_(peer_is_parent), peer_exited_(false) {}
+
+bool SharedMemoryTransport::peer_alive() {
+#ifdef SUBWAY_HAS_SHM
+    if (peer_exited_) return false;
+    if (peer_is_parent_) {
+        peer_exited_ = getppid() != peer_pid_;
+    } else {
+        int status = 0;
+        peer_exited_ = waitpid(peer_pid_, &status, WNOHANG) == peer_pid_;
+    }
+    return !peer_exited_;
+#else
+    return false;
+#endif
+}
+
+bool SharedMemoryTransport::send(const ShardMessage& message) {
+    unsigned long long tail = outgoing_->tail.load(std::memory_order_relaxed);
+    for (int attempt = 0; tail - outgoing_->head.load(std::memory_order_acquire) >= ShmRing::kCapacity; ++attempt) {
+        if (attempt % 1024 == 1023 && !peer_alive()) return false;
+        backoff(attempt);
+    }
+    outgoing_->slots[tail % ShmRing::kCapacity] = message;
+    outgoing_->tail.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+bool SharedMemoryTransport::receive(ShardMessage& message) {
+    unsigned long long head = incoming_->head.load(std::memory_order_relaxed);
+    for (int attempt = 0; incoming_->tail.load(std::memory_order_acquire) == head; ++attempt) {
+        // A peer may write its last message and exit; only give up on an empty ring.
+        if (attempt % 1024 == 1023 && !peer_alive() &&
+            incoming_->tail.load(std::memory_order_acquire) == head) {
+            return false;
+        }
+        backoff(attempt);
+    }
+    message = incoming_->slots[head % ShmRing::kCapacity];
+    incoming_->head.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+SharedMemoryChannels::SharedMemoryChannels(int workers)
+    : workers_(workers), bytes_(sizeof(ShmRing) * 2 * static_cast<size_t>(workers)), rings_(nullptr) {
+#ifdef SUBWAY_HAS_SHM
+    void* memory = mmap(nullptr, bytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) return;
+    rings_ = static_cast<ShmRing*>(memory);
+    for (int i = 0; i < 2 * workers_; ++i) {
+        ShmRing* ring = new (&rings_[i]) ShmRing;
+        ring->head.store(0);
+        ring->tail.store(0);
+    }
+#endif
+}
+
+SharedMemoryChannels::~SharedMemoryChannels() {
+#ifdef SUBWAY_HAS_SHM
+    if (rings_) munmap(rings_, bytes_);
+#endif
+}
+
+// Ring 2*w carries worker -> coordinator, ring 2*w+1 coordinator -> worker.
+SharedMemoryTransport SharedMemoryChannels::worker_end(int worker, int coordinator_pid) const {
+    return SharedMemoryTransport(&rings_[2 * worker], &rings_[2 * worker + 1], coordinator_pid, true);
+}
+
+SharedMemoryTransport SharedMemoryChannels::coordinator_end(int worker, int worker_pid) const {
+    return SharedMemoryTransport(&rings_[2 * worker + 1], &rings_[2 * worker], worker_pid, false);
+}
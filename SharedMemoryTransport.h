@@ -0,0 +1,55 @@
+#ifndef SHARED_MEMORY_TRANSPORT_H
+#define SHARED_MEMORY_TRANSPORT_H
+
+#include "ShardTransport.h"
+#include <atomic>
+#include <cstddef>
+
+// Single-producer / single-consumer ring placed in a MAP_SHARED mapping,
+// so a forked worker and the coordinator see the same slots.
+struct ShmRing {
+    static const size_t kCapacity = 1024;
+
+    std::atomic<unsigned long long> head; // next slot to read
+    std::atomic<unsigned long long> tail; // next slot to write
+    ShardMessage slots[kCapacity];
+};
+
+class SharedMemoryTransport : public ShardTransport {
+public:
+    // peer_is_parent: the worker side watches its parent, the coordinator side its child.
+    SharedMemoryTransport(ShmRing* outgoing, ShmRing* incoming, int peer_pid, bool peer_is_parent);
+
+    bool send(const ShardMessage& message) override;
+    bool receive(ShardMessage& message) override;
+
+private:
+    bool peer_alive();
+
+    ShmRing* outgoing_;
+    ShmRing* incoming_;
+    int peer_pid_;
+    bool peer_is_parent_;
+    bool peer_exited_;
+};
+
+// Owns the shared mapping with one ring in each direction per worker.
+// Create it before forking so every worker inherits the mapping.
+class SharedMemoryChannels {
+public:
+    explicit SharedMemoryChannels(int workers);
+    ~SharedMemoryChannels();
+    SharedMemoryChannels(const SharedMemoryChannels&) = delete;
+    SharedMemoryChannels& operator=(const SharedMemoryChannels&) = delete;
+
+    bool valid() const { return rings_ != nullptr; }
+    SharedMemoryTransport worker_end(int worker, int coordinator_pid) const;
+    SharedMemoryTransport coordinator_end(int worker, int worker_pid) const;
+
+private:
+    int workers_;
+    size_t bytes_;
+    ShmRing* rings_;
+};
+
+#endif // SHARED_MEMORY_TRANSPORT_H
@@ -1,7 +1,17 @@
 #include "SimulationManager.h"
+#include "EventSimulation.h"
+#include "ShardCoordinator.h"
+#include "TimingWheel.h"
+#include <algorithm>
+#include <condition_variable>
 #include <iostream>
+#include <iomanip>
+#include <sstream>
 #include <thread>
 #include <limits>
+#include <ctime>
+
+extern SystemMonitor monitor;
 
 void clear_display() {
     std::cout << "\033[2J\033[1;1H" << std::flush;
@@ -12,7 +22,24 @@ void clear_display() {
 #endif
 }
 
-SimulationManager::SimulationManager() : network_(), monitor_(), output_mutex_() {}
+static std::string format_minutes(long long ms) {
+    long long seconds = ms / 1000;
+    std::string secs = std::to_string(seconds % 60);
+    return std::to_string(seconds / 60) + ":" + (secs.size() < 2 ? "0" : "") + secs;
+}
+
+// Real-time runs start the simulated clock at the current local time of day.
+static long long current_time_of_day_ms() {
+    time_t now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+    struct tm* time_info = localtime(&now);
+    return ((time_info->tm_hour * 60LL + time_info->tm_min) * 60 + time_info->tm_sec) * 1000;
+}
+
+SimulationManager::SimulationManager()
+    : network_(), queues_(network_, DemandProfile(), current_time_of_day_ms()), monitor_(), output_mutex_() {}
+
+SimulationManager::SimulationManager(const SimulationOptions& options)
+    : network_(), queues_(network_, DemandProfile(), current_time_of_day_ms()), monitor_(), output_mutex_(), options_(options) {}
 
 void SimulationManager::show_welcome() {
     const char* transit_art[] = {
@@ -143,21 +170,165 @@ void SimulationManager::collect_train_counts(int& red_trains, int& green_trains,
     std::this_thread::sleep_for(std::chrono::milliseconds(2000));
 }
 
+void SimulationManager::resolve_train_counts(int& red_trains, int& green_trains, int& purple_trains, int& light_green_trains) {
+    const int* preset = options_.preset_trains;
+    if (preset[0] >= 0 && preset[1] >= 0 && preset[2] >= 0 && preset[3] >= 0) {
+        red_trains = preset[0];
+        green_trains = preset[1];
+        purple_trains = preset[2];
+        light_green_trains = preset[3];
+        return;
+    }
+    collect_train_counts(red_trains, green_trains, purple_trains, light_green_trains);
+}
+
+std::unique_ptr<KpiExporter> SimulationManager::open_kpi_exporter() {
+    if (options_.kpi_prefix.empty()) return nullptr;
+    std::unique_ptr<KpiExporter> exporter(new KpiExporter(network_, options_.kpi_prefix));
+    if (!exporter->ok()) {
+        std::cout << "❌ KPI export disabled: " << exporter->error() << "\n";
+        return nullptr;
+    }
+    return exporter;
+}
+
+static std::vector<const LineKpis*> kpi_views(const std::vector<LineKpis>& lines) {
+    std::vector<const LineKpis*> views;
+    for (const auto& line : lines) {
+        views.push_back(&line);
+    }
+    return views;
+}
+
+void SimulationManager::run_event_simulation() {
+    int red_trains, green_trains, purple_trains, light_green_trains;
+    resolve_train_counts(red_trains, green_trains, purple_trains, light_green_trains);
+
+    EventSimulation::Config config;
+    config.seed = options_.seed;
+    config.duration_ms = static_cast<long long>(options_.sim_hours * 3600.0 * 1000.0);
+    config.parallel = options_.parallel;
+    auto exporter = open_kpi_exporter();
+    if (exporter) config.kpi_every_ms = static_cast<long long>(options_.kpi_every_hours * 3600.0 * 1000.0);
+
+    EventSimulation simulation(network_, config);
+    if (exporter) {
+        simulation.set_snapshot_handler([&](long long elapsed_ms) {
+            exporter->write_snapshot(elapsed_ms, simulation.line_kpis());
+        });
+    }
+    simulation.add_trains("Red", red_trains);
+    simulation.add_trains("Green", green_trains);
+    simulation.add_trains("Purple", purple_trains);
+    simulation.add_trains("Light Green", light_green_trains);
+
+    std::string layout = options_.shards > 0 ? std::to_string(std::min(options_.shards, simulation.line_count())) + " worker processes"
+                         : options_.parallel ? "one thread per line" : "sequential";
+    std::cout << "🚆 Event-driven run: " << options_.sim_hours << " simulated hours, "
+              << layout << ", seed " << options_.seed << "\n";
+    auto wall_start = std::chrono::steady_clock::now();
+    if (options_.shards > 0) {
+        ShardCoordinator coordinator(simulation, options_.shards);
+        if (!coordinator.run()) {
+            std::cout << "❌ Sharded run failed: " << coordinator.error() << "\n";
+            return;
+        }
+    } else {
+        simulation.run();
+    }
+    auto wall_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - wall_start).count();
+
+    for (const auto& line : simulation.results()) {
+        std::cout << "🛤️ " << line.line << ": " << line.events << " events, " << line.arrivals << " arrivals, "
+                  << line.transfers_in << " transfers in, " << line.transfers_out << " transfers out\n";
+    }
+    std::cout << "Run digest: " << std::hex << std::setw(16) << std::setfill('0') << simulation.digest()
+              << std::dec << std::setfill(' ') << " (" << wall_ms << " ms)\n";
+
+    simulation.merge_into(monitor_);
+    monitor_.print_summary();
+    print_kpi_summary(network_, simulation.line_kpis());
+    if (exporter) {
+        exporter->write_snapshot(config.duration_ms, simulation.line_kpis());
+        std::cout << "💾 KPIs written to " << options_.kpi_prefix << ".csv and " << options_.kpi_prefix << ".kpi\n";
+    }
+}
+
+TimetableSearchResult SimulationManager::run_timetable_search(const std::array<int, baku::kLineCount>& fleet) {
+    TimetableCompiler compiler(network_);
+    int threads = std::max(1u, std::thread::hardware_concurrency());
+    TimetableSearchResult result = search_timetables(compiler, DemandProfile(), queues_.start_ms(), fleet, threads);
+
+    // Formatted locally so std::cout keeps its own flags.
+    std::ostringstream out;
+    out << "🔎 Scored " << result.candidates << " candidate timetables in " << std::fixed << std::setprecision(1)
+        << result.seconds * 1000.0 << " ms on " << result.threads << " threads ("
+        << std::setprecision(0) << result.candidates / std::max(result.seconds, 1e-9) << " per second)\n";
+    for (int line = 0; line < baku::kLineCount; ++line) {
+        const auto& best = result.best[line];
+        out << "📅 " << network_.route(line).name << ": ";
+        if (best.trains_in_service == 0) {
+            out << "no trains\n";
+            continue;
+        }
+        out << best.trains_in_service << " of " << fleet[line] << " trains every " << format_minutes(best.headway_ms)
+            << ", round trip " << format_minutes(best.min_cycle_ms) << ", score " << std::setprecision(1)
+            << result.best_score[line] << "\n";
+    }
+    std::cout << out.str();
+    return result;
+}
+
 void SimulationManager::start_operations() {
+    if (options_.event_driven) {
+        run_event_simulation();
+        return;
+    }
+
+    if (options_.search_timetables) {
+        int red_trains, green_trains, purple_trains, light_green_trains;
+        resolve_train_counts(red_trains, green_trains, purple_trains, light_green_trains);
+        run_timetable_search({red_trains, green_trains, purple_trains, light_green_trains});
+        return;
+    }
+
     show_welcome();
 
     int red_trains, green_trains, purple_trains, light_green_trains;
-    collect_train_counts(red_trains, green_trains, purple_trains, light_green_trains);
+    resolve_train_counts(red_trains, green_trains, purple_trains, light_green_trains);
+
+    const bool timetabled = options_.timetable;
+    if (options_.timetable_auto) {
+        timetables_ = run_timetable_search({red_trains, green_trains, purple_trains, light_green_trains}).best;
+    } else if (timetabled) {
+        TimetableCompiler compiler(network_);
+        const int fleet[] = {red_trains, green_trains, purple_trains, light_green_trains};
+        auto headway_ms = static_cast<long long>(options_.timetable_headway_s * 1000.0);
+        for (int line = 0; line < baku::kLineCount; ++line) {
+            timetables_[line] = compiler.compile(line, headway_ms, fleet[line]);
+            std::cout << "📅 " << network_.route(line).name << ": " << timetables_[line].trains_in_service
+                      << " trains every " << format_minutes(timetables_[line].headway_ms) << "\n";
+        }
+    }
 
-    std::vector<std::thread> operators;
     int train_id = 1;
+    operators_.clear();
+    operators_.reserve(red_trains + green_trains + purple_trains + light_green_trains);
+    auto run_length = std::chrono::milliseconds(static_cast<long long>(options_.realtime_minutes * 60.0 * 1000.0));
+    // Timetables, adherence and KPI snapshots all count from here.
+    auto run_start = std::chrono::steady_clock::now();
 
     // Helper function to add trains for a line
     auto add_trains = [&](const std::string& line, int count) {
         for (int i = 0; i < count; ++i) {
             bool is_forward = (i % 2 == 0); // Alternate directions
-            operators.emplace_back(&TrainOperator::start_journey,
-                                   TrainOperator(train_id++, line, is_forward, network_, output_mutex_));
+            operators_.emplace_back(train_id++, line, is_forward, network_, queues_, output_mutex_);
+            operators_.back().set_run_length(run_length);
+            if (timetabled) {
+                // Paced logging sleeps under the output lock and would hold every train behind its schedule.
+                operators_.back().set_paced_logging(false);
+                operators_.back().follow_timetable(timetables_[network_.route_index(line)], i, adherence_, run_start);
+            }
         }
     };
 
@@ -166,9 +337,82 @@ void SimulationManager::start_operations() {
     add_trains("Purple", purple_trains);
     add_trains("Light Green", light_green_trains);
 
-    for (auto& thread : operators) {
-        thread.join();
+    KpiBoard kpis(network_);
+    TractionModel traction;
+    FleetSegments segments(traction);
+    for (auto& train : operators_) {
+        train.set_kpis(kpis);
+        train.set_segments(segments);
+    }
+
+    // Periodic KPI snapshots come from a side thread; the trains never wait on it.
+    const long long sim_scale = 120;
+    auto exporter = open_kpi_exporter();
+    auto elapsed_sim_ms = [&] {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - run_start).count() * sim_scale;
+    };
+    std::mutex export_mutex;
+    std::condition_variable export_cv;
+    bool trains_done = false;
+    std::thread export_thread;
+    if (exporter && options_.kpi_every_hours > 0) {
+        auto period = std::chrono::milliseconds(static_cast<long long>(options_.kpi_every_hours * 3600.0 * 1000.0 / sim_scale));
+        export_thread = std::thread([&, period] {
+            std::unique_lock<std::mutex> lock(export_mutex);
+            while (!export_cv.wait_for(lock, period, [&] { return trains_done; })) {
+                auto lines = kpis.snapshot();
+                exporter->write_snapshot(elapsed_sim_ms(), kpi_views(lines));
+            }
+        });
     }
 
+    if (options_.wheel_workers > 0) {
+        TimingWheel wheel(options_.wheel_workers);
+        for (auto& train : operators_) {
+            train.set_paced_logging(false);
+            size_t task = wheel.add([&train] { return train.step(); });
+            train.set_waker([&wheel, task] { wheel.wake(task); });
+        }
+        wheel.run();
+
+        WakeupStats stats = wheel.stats();
+        std::ostringstream out;
+        out << std::fixed << std::setprecision(2)
+            << "⏱️ Wakeups: " << stats.wakeups << " on " << options_.wheel_workers << " workers, latency mean "
+            << stats.mean_ms << " ms, jitter " << stats.jitter_ms << " ms, p99 " << stats.p99_ms
+            << " ms, max " << stats.max_ms << " ms\n";
+        std::cout << out.str();
+    } else {
+        std::vector<std::thread> operators;
+        for (auto& train : operators_) {
+            operators.emplace_back(&TrainOperator::start_journey, &train);
+        }
+        for (auto& thread : operators) {
+            thread.join();
+        }
+    }
+
+    if (export_thread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(export_mutex);
+            trains_done = true;
+        }
+        export_cv.notify_all();
+        export_thread.join();
+    }
+
+    double kwh = segments.drain_kwh();
+    monitor.log_energy_use(kwh, traction.cost(kwh));
+
+    // Trains report to the global monitor.
+    monitor_.merge(monitor);
     monitor_.print_summary();
+    if (timetabled) adherence_.print_summary();
+
+    auto lines = kpis.snapshot();
+    print_kpi_summary(network_, kpi_views(lines));
+    if (exporter) {
+        exporter->write_snapshot(elapsed_sim_ms(), kpi_views(lines));
+        std::cout << "💾 KPIs written to " << options_.kpi_prefix << ".csv and " << options_.kpi_prefix << ".kpi\n";
+    }
 }
@@ -4,24 +4,56 @@
 #include "TransitNetwork.h"
 #include "TrainOperator.h"
 #include "SystemMonitor.h"
+#include "StationDemand.h"
+#include "Timetable.h"
+#include "KpiExport.h"
+#include <memory>
+#include <string>
 #include <vector>
 #include <thread>
 void clear_display();
+
+struct SimulationOptions {
+    bool event_driven = false;      // discrete-event run instead of wall-clock threads
+    bool parallel = false;          // one thread per line in event-driven mode
+    int shards = 0;                 // worker processes for the event-driven run, 0 keeps it in-process
+    int wheel_workers = 0;          // real-time trains paced by a timing wheel on this many threads, 0 = thread per train
+    double realtime_minutes = 10.0; // wall-clock length of a real-time run
+    bool timetable = false;         // real-time trains follow a timetable instead of random dwells
+    bool timetable_auto = false;    // use the best timetable found by search rather than a fixed headway
+    double timetable_headway_s = 0; // headway of the fixed timetable
+    bool search_timetables = false; // only score candidate timetables for the fleet and print the best
+    std::string kpi_prefix;         // export KPI histograms to <prefix>.csv and <prefix>.kpi, empty = off
+    double kpi_every_hours = 0;     // also export every this many simulated hours, 0 = only at the end
+    unsigned seed = 2025;
+    double sim_hours = 20.0;
+    int preset_trains[4] = {-1, -1, -1, -1}; // Red, Green, Purple, Light Green; -1 asks the user
+};
+
 class SimulationManager {
 public:
 
     SimulationManager();//std::chrono::system_clock::time_point end_time);
+    explicit SimulationManager(const SimulationOptions& options);
     void start_operations();
     void collect_train_counts(int& red_trains, int& green_trains, int& purple_trains, int& light_green_trains);
         bool running;
     void collect_end_time();
 private:
     TransitNetwork network_;
+    StationQueues queues_;
     SystemMonitor monitor_;
     std::mutex output_mutex_;
     void show_welcome();
     void stop_operators();
+    void resolve_train_counts(int& red_trains, int& green_trains, int& purple_trains, int& light_green_trains);
+    void run_event_simulation();
+    std::unique_ptr<KpiExporter> open_kpi_exporter();
+    TimetableSearchResult run_timetable_search(const std::array<int, baku::kLineCount>& fleet);
+    SimulationOptions options_;
     std::vector<TrainOperator> operators_;
+    std::array<LineTimetable, baku::kLineCount> timetables_;
+    ScheduleAdherence adherence_;
 
     std::chrono::system_clock::time_point end_time_;
 };
@@ -0,0 +1,77 @@
+#include "StationDemand.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const long long kMsPerHour = 3600LL * 1000;
+
+// Night service is nearly empty, peaks at 7-9 and 17-19.
+const std::array<double, 24> kWeekdayProfile = {{
+    0.30, 0.05, 0.05, 0.05, 0.05, 0.10, 0.60, 1.80, 2.00, 1.20, 0.90, 0.90,
+    1.00, 1.00, 0.90, 0.90, 1.10, 1.90, 2.00, 1.30, 0.90, 0.70, 0.50, 0.40
+}};
+
+} // namespace
+
+DemandProfile::DemandProfile() : DemandProfile(kWeekdayProfile) {}
+
+DemandProfile::DemandProfile(const std::array<double, 24>& hourly_multiplier) : hourly_(hourly_multiplier) {
+    cumulative_[0] = 0.0;
+    for (int hour = 0; hour < 24; ++hour) {
+        cumulative_[hour + 1] = cumulative_[hour] + hourly_[hour];
+    }
+}
+
+double DemandProfile::multiplier(long long time_ms) const {
+    return hourly_[(time_ms / kMsPerHour) % 24];
+}
+
+double DemandProfile::cumulative(long long time_ms) const {
+    long long day = time_ms / (24 * kMsPerHour);
+    long long hour_of_day = (time_ms / kMsPerHour) % 24;
+    double into_hour = static_cast<double>(time_ms % kMsPerHour) / kMsPerHour;
+    return day * cumulative_[24] + cumulative_[hour_of_day] + hourly_[hour_of_day] * into_hour;
+}
+
+StationQueues::StationQueues(const TransitNetwork& network, const DemandProfile& profile, long long start_ms)
+    : profile_(profile), start_ms_(start_ms) {
+    for (int line = 0; line < baku::kLineCount; ++line) {
+        for (int station = 0; station < baku::kStationCount; ++station) {
+            queues_[slot(line, station)] = Queue{0.0, 0.0, start_ms, network.platform_traffic(station), 0};
+        }
+    }
+}
+
+StationQueues::Queue& StationQueues::catch_up(int line, int station, long long now_ms) {
+    Queue& queue = queues_[slot(line, station)];
+    if (now_ms > queue.updated_ms) {
+        // New arrivals are spread evenly over the interval, so on average they waited half of it.
+        double elapsed = static_cast<double>(now_ms - queue.updated_ms);
+        double arrived = queue.base_traffic * profile_.arrivals(queue.updated_ms, now_ms);
+        queue.waited_ms += queue.waiting * elapsed + arrived * elapsed / 2.0;
+        queue.waiting += arrived;
+        queue.updated_ms = now_ms;
+    }
+    return queue;
+}
+
+StationQueues::Boarding StationQueues::board(int line, int station, long long now_ms, int free_space) {
+    Queue& queue = catch_up(line, station, now_ms);
+    int ready = static_cast<int>(std::floor(queue.waiting));
+    int boarded = std::min(ready, std::max(0, free_space));
+    double mean_wait_ms = queue.waiting > 0.0 ? queue.waited_ms / queue.waiting : 0.0;
+    queue.waiting -= boarded;
+    queue.waited_ms = std::max(0.0, queue.waited_ms - boarded * mean_wait_ms);
+
+    // The longest waiting board first, so riders left behind before go ahead
+    // of new ones, and each rider counts as denied once however often they miss.
+    int left = ready - boarded;
+    int still_left_behind = std::max(0, std::min(queue.left_behind, ready) - boarded);
+    queue.left_behind = left;
+    return Boarding{boarded, left - still_left_behind, mean_wait_ms};
+}
+
+void StationQueues::add_waiting(int line, int station, long long now_ms, int riders) {
+    catch_up(line, station, now_ms).waiting += riders;
+}
@@ -0,0 +1,62 @@
+#ifndef STATION_DEMAND_H
+#define STATION_DEMAND_H
+
+#include "TransitNetwork.h"
+#include <array>
+
+// Piecewise-constant passenger arrival rate over the day. A cumulative table
+// turns "how many arrived between t0 and t1" into two lookups. Times are
+// simulated milliseconds since midnight and may run past one day.
+class DemandProfile {
+public:
+    DemandProfile(); // weekday profile with morning and evening peaks
+    explicit DemandProfile(const std::array<double, 24>& hourly_multiplier);
+
+    double multiplier(long long time_ms) const;
+    // Expected arrivals per unit of base traffic from midnight of day 0 to time_ms.
+    double cumulative(long long time_ms) const;
+    double arrivals(long long from_ms, long long to_ms) const { return cumulative(to_ms) - cumulative(from_ms); }
+
+private:
+    std::array<double, 24> hourly_;
+    std::array<double, 25> cumulative_;
+};
+
+// Passengers waiting on each line's platform at each station. A queue is only
+// touched when a train calls there: the arrivals since the previous call are
+// added in one step, so idle stations cost nothing.
+// Callers serialize access per platform (the station lock in real-time mode,
+// the owning partition in the event-driven one).
+class StationQueues {
+public:
+    struct Boarding {
+        int boarded;
+        int denied; // left on the platform by a full train for the first time
+        double mean_wait_ms; // of the riders who boarded
+    };
+
+    StationQueues(const TransitNetwork& network, const DemandProfile& profile, long long start_ms);
+
+    long long start_ms() const { return start_ms_; }
+    Boarding board(int line, int station, long long now_ms, int free_space);
+    void add_waiting(int line, int station, long long now_ms, int riders);
+    double waiting(int line, int station) const { return queues_[slot(line, station)].waiting; }
+
+private:
+    struct Queue {
+        double waiting;
+        double waited_ms; // time already spent on the platform by everyone waiting, summed
+        long long updated_ms;
+        double base_traffic; // passengers per hour at multiplier 1, this platform's share
+        int left_behind;     // waiting riders already counted as denied
+    };
+
+    static int slot(int line, int station) { return line * baku::kStationCount + station; }
+    Queue& catch_up(int line, int station, long long now_ms);
+
+    DemandProfile profile_;
+    long long start_ms_;
+    std::array<Queue, baku::kLineCount * baku::kStationCount> queues_;
+};
+
+#endif // STATION_DEMAND_H
@@ -4,13 +4,19 @@
 
 SystemMonitor monitor; // Global instance
 
-SystemMonitor::SystemMonitor() : total_riders_(0), active_riders_(0), energy_expense_(0.0), incident_expense_(0.0) {}
+SystemMonitor::SystemMonitor() : total_riders_(0), total_alighted_(0), active_riders_(0), denied_boardings_(0), energy_expense_(0.0), energy_kwh_(0.0), incident_expense_(0.0) {}
 
-void SystemMonitor::record_passengers(int boarding, int alighting) {
+void SystemMonitor::record_passengers(long long boarding, long long alighting) {
     std::lock_guard<std::mutex> lock(rider_lock_);
     active_riders_ = active_riders_ - alighting + boarding;
     if (active_riders_ < 0) active_riders_ = 0;
     if (boarding > 0) total_riders_ += boarding;
+    if (alighting > 0) total_alighted_ += alighting;
+}
+
+void SystemMonitor::record_denied(long long riders) {
+    std::lock_guard<std::mutex> lock(rider_lock_);
+    denied_boardings_ += riders;
 }
 
 void SystemMonitor::log_energy_cost(double cost) {
@@ -18,11 +24,33 @@ void SystemMonitor::log_energy_cost(double cost) {
     energy_expense_ += cost;
 }
 
+void SystemMonitor::log_energy_use(double kwh, double cost) {
+    std::lock_guard<std::mutex> lock(cost_lock_);
+    energy_kwh_ += kwh;
+    energy_expense_ += cost;
+}
+
 void SystemMonitor::log_incident_cost(double cost) {
     std::lock_guard<std::mutex> lock(cost_lock_);
     incident_expense_ += cost;
 }
 
+void SystemMonitor::merge(const SystemMonitor& other) {
+    {
+        std::lock_guard<std::mutex> lock(rider_lock_);
+        std::lock_guard<std::mutex> other_lock(other.rider_lock_);
+        total_riders_ += other.total_riders_;
+        total_alighted_ += other.total_alighted_;
+        active_riders_ += other.active_riders_;
+        denied_boardings_ += other.denied_boardings_;
+    }
+    std::lock_guard<std::mutex> lock(cost_lock_);
+    std::lock_guard<std::mutex> other_lock(other.cost_lock_);
+    energy_expense_ += other.energy_expense_;
+    energy_kwh_ += other.energy_kwh_;
+    incident_expense_ += other.incident_expense_;
+}
+
 void SystemMonitor::print_summary() {
     const double ticket_price = 0.5;
     const double upkeep_cost = 500.0;
@@ -32,7 +60,9 @@ void SystemMonitor::print_summary() {
 
     std::lock_guard<std::mutex> lock(rider_lock_);
     std::cout << "Total passengers served: " << total_riders_ << std::endl;
+    std::cout << "Passengers denied boarding: " << denied_boardings_ << std::endl;
     std::cout << "Revenue: " << std::fixed << std::setprecision(2) << income << " Bucks" << std::endl;
+    std::cout << "Traction energy: " << std::fixed << std::setprecision(2) << energy_kwh_ << " kWh" << std::endl;
     std::cout << "Fuel expenses: " << std::fixed << std::setprecision(2) << energy_expense_ << " Bucks" << std::endl;
     std::cout << "Incident expenses: " << std::fixed << std::setprecision(2) << incident_expense_ << " Bucks" << std::endl;
     std::cout << "Maintenance cost: " << std::fixed << std::setprecision(2) << upkeep_cost << " Bucks" << std::endl;
@@ -6,18 +6,32 @@
 class SystemMonitor {
 public:
     SystemMonitor();
-    void record_passengers(int boarding, int alighting);
+    void record_passengers(long long boarding, long long alighting);
+    void record_denied(long long riders);
     void log_energy_cost(double cost);
+    void log_energy_use(double kwh, double cost);
     void log_incident_cost(double cost);
+    void merge(const SystemMonitor& other);
     void print_summary();
 
+    long long total_riders() const { return total_riders_; }
+    long long total_alighted() const { return total_alighted_; }
+    long long active_riders() const { return active_riders_; }
+    long long denied_boardings() const { return denied_boardings_; }
+    double energy_expense() const { return energy_expense_; }
+    double energy_kwh() const { return energy_kwh_; }
+    double incident_expense() const { return incident_expense_; }
+
 private:
     long long total_riders_;
-    int active_riders_;
+    long long total_alighted_;
+    long long active_riders_;
+    long long denied_boardings_;
     double energy_expense_;
+    double energy_kwh_;
     double incident_expense_;
-    std::mutex rider_lock_;
-    std::mutex cost_lock_;
+    mutable std::mutex rider_lock_;
+    mutable std::mutex cost_lock_;
 };
 
 #endif // SYSTEM_MONITOR_H
@@ -0,0 +1,207 @@
+#include "Timetable.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <thread>
+
+namespace {
+
+const long long kMsPerHour = 3600LL * 1000;
+const long long kOnTimeMs = 60 * 1000;
+
+// A round trip visits stops 0..n-1 and back down to 1 before repeating.
+int cyclic_stop(int position, int stop_count) {
+    return position < stop_count ? position : 2 * (stop_count - 1) - position;
+}
+
+} // namespace
+
+TimetableCompiler::TimetableCompiler(const TransitNetwork& network, const TimetableParams& params)
+    : network_(network), params_(params) {}
+
+// Trains start at the hub, one headway apart. The headway is stretched when
+// the fleet cannot cover the round trip, and surplus trains stay in the depot,
+// so the layover at the hub is always shorter than one headway.
+LineTimetable TimetableCompiler::compile(int line, long long headway_ms, int fleet) const {
+    const auto& route = network_.route(line);
+    const int stop_count = route.stop_count;
+    LineTimetable timetable;
+    timetable.line = line;
+    if (stop_count < 2 || fleet <= 0) return timetable;
+
+    int hub_index = 0;
+    for (int i = 0; i < stop_count; ++i) {
+        if (route.stop(i) == route.hub) {
+            hub_index = i;
+            break;
+        }
+    }
+    const int visits = 2 * (stop_count - 1);
+    const int start = hub_index < stop_count - 1 ? hub_index : visits - hub_index;
+    timetable.start_stop = hub_index;
+    timetable.start_direction = start < stop_count - 1 ? 1 : -1;
+
+    timetable.visit_stop.resize(visits);
+    timetable.departure_ms.resize(visits);
+    long long departure = params_.dwell_ms;
+    for (int v = 0; v < visits; ++v) {
+        int stop = cyclic_stop((start + v) % visits, stop_count);
+        int next = cyclic_stop((start + v + 1) % visits, stop_count);
+        timetable.visit_stop[v] = stop;
+        timetable.departure_ms[v] = static_cast<int>(departure - params_.dwell_ms);
+        double km = network_.distance_between(route.stop(stop), route.stop(next));
+        long long run_ms = std::max(params_.min_run_ms, static_cast<long long>(km / params_.speed_kmh * kMsPerHour));
+        departure += run_ms + params_.dwell_ms;
+    }
+    timetable.first_departure_ms = params_.dwell_ms;
+    timetable.min_cycle_ms = departure - params_.dwell_ms;
+
+    headway_ms = std::max<long long>(1000, headway_ms);
+    long long needed = (timetable.min_cycle_ms + headway_ms - 1) / headway_ms;
+    timetable.trains_in_service = static_cast<int>(std::min<long long>(fleet, needed));
+    long long stretched = (timetable.min_cycle_ms + timetable.trains_in_service - 1) / timetable.trains_in_service;
+    timetable.headway_ms = (std::max(headway_ms, stretched) + 999) / 1000 * 1000;
+    timetable.cycle_ms = timetable.trains_in_service * timetable.headway_ms;
+    return timetable;
+}
+
+// Closed-form cost of running the timetable for one service day: passenger
+// waiting time from the gaps between departures at each stop, crowding beyond
+// capacity in each hour, and train-hours. No events are simulated.
+double TimetableCompiler::score(const LineTimetable& timetable, const DemandProfile& profile, long long start_ms) const {
+    if (timetable.trains_in_service == 0) return std::numeric_limits<double>::infinity();
+
+    const auto& route = network_.route(timetable.line);
+    const long long headway = timetable.headway_ms;
+    const long long service_ms = static_cast<long long>(params_.service_hours * kMsPerHour);
+    const double day_demand = profile.arrivals(start_ms, start_ms + service_ms);
+
+    double wait_ms = 0.0;
+    double peak_rate = 0.0; // boardings per train at multiplier 1
+    std::array<long long, 2> offsets{};
+    for (int stop = 0; stop < route.stop_count; ++stop) {
+        // Trains are one headway apart and the cycle is a whole number of
+        // headways, so the departure gaps at a stop repeat every headway.
+        int calls = 0;
+        for (int v = 0; v < timetable.visits_per_cycle() && calls < 2; ++v) {
+            if (timetable.visit_stop[v] == stop) offsets[calls++] = timetable.departure_ms[v] % headway;
+        }
+        long long widest = headway;
+        double gaps_sq = static_cast<double>(headway) * headway;
+        if (calls == 2) {
+            long long gap = std::abs(offsets[1] - offsets[0]);
+            widest = std::max(gap, headway - gap);
+            gaps_sq = static_cast<double>(gap) * gap + static_cast<double>(headway - gap) * (headway - gap);
+        }
+        double traffic = network_.platform_traffic(route.stop(stop));
+        wait_ms += traffic * day_demand * gaps_sq / (2.0 * headway);
+        peak_rate += traffic * widest / kMsPerHour;
+    }
+
+    // Riders spread over the stops ahead, so a train carries about half of
+    // what it picks up along the line.
+    double overflow = 0.0;
+    for (long long hour = start_ms / kMsPerHour; hour * kMsPerHour < start_ms + service_ms; ++hour) {
+        double load = 0.5 * peak_rate * profile.multiplier(hour * kMsPerHour);
+        overflow += std::max(0.0, load - params_.capacity) * (kMsPerHour / static_cast<double>(headway));
+    }
+
+    double wait_hours = wait_ms / kMsPerHour;
+    double train_hours = timetable.trains_in_service * params_.service_hours;
+    return wait_hours * params_.value_of_time + train_hours * params_.train_hour_cost + overflow * params_.overflow_penalty;
+}
+
+TimetableSearchResult search_timetables(const TimetableCompiler& compiler, const DemandProfile& profile,
+                                        long long start_ms, const std::array<int, baku::kLineCount>& fleet, int threads) {
+    const long long min_headway_ms = 60 * 1000;
+    const long long headway_step_ms = 5 * 1000;
+    const int headway_steps = 229; // up to 20 minutes
+
+    struct Candidate {
+        int line;
+        long long headway_ms;
+        int trains;
+    };
+    std::vector<Candidate> candidates;
+    for (int line = 0; line < baku::kLineCount; ++line) {
+        for (int trains = 1; trains <= fleet[line]; ++trains) {
+            for (int step = 0; step < headway_steps; ++step) {
+                candidates.push_back(Candidate{line, min_headway_ms + step * headway_step_ms, trains});
+            }
+        }
+    }
+
+    TimetableSearchResult result;
+    result.best_score.fill(std::numeric_limits<double>::infinity());
+    result.threads = std::max(1, threads);
+    result.candidates = static_cast<long long>(candidates.size());
+
+    std::atomic<size_t> next(0);
+    std::mutex best_mutex;
+    auto worker = [&] {
+        const size_t chunk = 256;
+        std::array<LineTimetable, baku::kLineCount> best;
+        std::array<double, baku::kLineCount> best_score;
+        best_score.fill(std::numeric_limits<double>::infinity());
+        for (size_t begin = next.fetch_add(chunk); begin < candidates.size(); begin = next.fetch_add(chunk)) {
+            size_t end = std::min(candidates.size(), begin + chunk);
+            for (size_t i = begin; i < end; ++i) {
+                const auto& candidate = candidates[i];
+                LineTimetable timetable = compiler.compile(candidate.line, candidate.headway_ms, candidate.trains);
+                double score = compiler.score(timetable, profile, start_ms);
+                if (score < best_score[candidate.line]) {
+                    best_score[candidate.line] = score;
+                    best[candidate.line] = std::move(timetable);
+                }
+            }
+        }
+        // Ties go to the smaller fleet and then the shorter headway, whichever thread found them.
+        std::lock_guard<std::mutex> lock(best_mutex);
+        for (int line = 0; line < baku::kLineCount; ++line) {
+            auto key = [](const LineTimetable& t) { return std::make_pair(t.trains_in_service, t.headway_ms); };
+            if (best_score[line] < result.best_score[line] ||
+                (best_score[line] == result.best_score[line] && best_score[line] < std::numeric_limits<double>::infinity() &&
+                 key(best[line]) < key(result.best[line]))) {
+                result.best_score[line] = best_score[line];
+                result.best[line] = best[line];
+            }
+        }
+    };
+
+    auto started = std::chrono::steady_clock::now();
+    std::vector<std::thread> pool;
+    for (int i = 0; i < result.threads; ++i) {
+        pool.emplace_back(worker);
+    }
+    for (auto& thread : pool) {
+        thread.join();
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    return result;
+}
+
+void ScheduleAdherence::record(long long delay_ms) {
+    std::lock_guard<std::mutex> lock(lock_);
+    departures_++;
+    if (std::abs(delay_ms) <= kOnTimeMs) on_time_++;
+    total_delay_ms_ += delay_ms;
+    max_delay_ms_ = std::max(max_delay_ms_, delay_ms);
+}
+
+void ScheduleAdherence::print_summary() const {
+    std::lock_guard<std::mutex> lock(lock_);
+    if (departures_ == 0) {
+        std::cout << "📅 Schedule adherence: no timetabled departures" << std::endl;
+        return;
+    }
+    std::ostringstream out;
+    out << "📅 Schedule adherence: " << departures_ << " departures, " << std::fixed << std::setprecision(1)
+        << 100.0 * on_time_ / departures_ << "% within 1 min, mean delay "
+        << total_delay_ms_ / 1000.0 / departures_ << " s, worst " << max_delay_ms_ / 1000.0 << " s";
+    std::cout << out.str() << std::endl;
+}
@@ -0,0 +1,87 @@
+#ifndef TIMETABLE_H
+#define TIMETABLE_H
+
+#include "TransitNetwork.h"
+#include "StationDemand.h"
+#include <array>
+#include <mutex>
+#include <vector>
+
+struct TimetableParams {
+    double speed_kmh = 40.0;        // same running speed as the real-time trains
+    long long min_run_ms = 30000;   // real-time trains never run a segment faster than this
+    long long dwell_ms = 30000;     // planned dwell, real dwell may be as short as 20 s
+    int capacity = 500;
+    double service_hours = 20.0;
+    double value_of_time = 3.0;     // bucks per passenger-hour of waiting
+    double train_hour_cost = 40.0;
+    double overflow_penalty = 1.0;  // bucks per passenger over capacity
+};
+
+// One line's timetable. Every train in service runs the same round trip,
+// spaced one headway apart, so a train's departures are its offset plus a
+// shared per-visit pattern: departure(train, visit) is O(1) and the whole
+// timetable is a few flat int arrays.
+struct LineTimetable {
+    int line = -1;
+    int trains_in_service = 0;
+    int start_stop = 0;
+    int start_direction = 1;
+    long long first_departure_ms = 0;
+    long long headway_ms = 0;
+    long long cycle_ms = 0;      // trains_in_service * headway_ms
+    long long min_cycle_ms = 0;  // round trip without layover
+    std::vector<int> visit_stop;    // stop index of each visit in one round trip
+    std::vector<int> departure_ms;  // departure of each visit after the train's first one
+
+    int visits_per_cycle() const { return static_cast<int>(visit_stop.size()); }
+    // Scheduled departure in simulated ms after service start.
+    long long departure(int train, long long visit) const {
+        long long cycle = visit / visits_per_cycle();
+        return first_departure_ms + train * headway_ms + cycle * cycle_ms + departure_ms[visit % visits_per_cycle()];
+    }
+};
+
+// Builds timetables from a target headway and fleet size, and scores them
+// against the demand profile with a closed-form estimate (no simulation),
+// so a search can try thousands of candidates per second.
+class TimetableCompiler {
+public:
+    TimetableCompiler(const TransitNetwork& network, const TimetableParams& params = TimetableParams());
+
+    LineTimetable compile(int line, long long headway_ms, int fleet) const;
+    double score(const LineTimetable& timetable, const DemandProfile& profile, long long start_ms) const;
+
+private:
+    const TransitNetwork& network_;
+    TimetableParams params_;
+};
+
+struct TimetableSearchResult {
+    std::array<LineTimetable, baku::kLineCount> best;
+    std::array<double, baku::kLineCount> best_score;
+    long long candidates = 0;
+    double seconds = 0.0;
+    int threads = 0;
+};
+
+// Tries headways from 60 s to 20 min in 5 s steps with 1..fleet trains for
+// every line, spread over worker threads, and keeps the lowest score.
+TimetableSearchResult search_timetables(const TimetableCompiler& compiler, const DemandProfile& profile,
+                                        long long start_ms, const std::array<int, baku::kLineCount>& fleet, int threads);
+
+// Departure delays against the timetable, shared by all trains.
+class ScheduleAdherence {
+public:
+    void record(long long delay_ms);
+    void print_summary() const;
+
+private:
+    mutable std::mutex lock_;
+    long long departures_ = 0;
+    long long on_time_ = 0;
+    long long total_delay_ms_ = 0;
+    long long max_delay_ms_ = 0;
+};
+
+#endif // TIMETABLE_H
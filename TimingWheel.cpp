@@ -0,0 +1,181 @@
+#include "TimingWheel.h"
+#include <algorithm>
+#include <cmath>
+
+TimingWheel::TimingWheel(int workers, std::chrono::milliseconds tick, size_t slots)
+    : worker_count_(std::max(1, workers)), tick_(std::max(tick, std::chrono::milliseconds(1))),
+      slots_(std::max<size_t>(slots, 1)), base_(Clock::now()), current_tick_(0), active_(0), stopping_(false) {}
+
+TimingWheel::~TimingWheel() {}
+
+size_t TimingWheel::add(Step step) {
+    tasks_.push_back(std::move(step));
+    return tasks_.size() - 1;
+}
+
+void TimingWheel::wake(size_t task) {
+    std::lock_guard<std::mutex> lock(wheel_mutex_);
+    insert_locked(Entry{task, 0, Clock::now()});
+}
+
+void TimingWheel::LatencyRecorder::record(double ms) {
+    count++;
+    sum += ms;
+    sum_sq += ms * ms;
+    max = std::max(max, ms);
+    int bucket = std::min(kBuckets - 1, static_cast<int>(ms * 10.0));
+    buckets[std::max(0, bucket)]++;
+}
+
+void TimingWheel::LatencyRecorder::merge(const LatencyRecorder& other) {
+    count += other.count;
+    sum += other.sum;
+    sum_sq += other.sum_sq;
+    max = std::max(max, other.max);
+    for (int i = 0; i < kBuckets; ++i) {
+        buckets[i] += other.buckets[i];
+    }
+}
+
+// Deadlines round up to the next tick; an entry due now fires on the next one.
+void TimingWheel::insert_locked(const Entry& entry) {
+    long long target = (entry.deadline - base_ + tick_ - Clock::duration(1)) / tick_;
+    if (target <= current_tick_) target = current_tick_ + 1;
+    Entry placed = entry;
+    placed.rounds = (target - current_tick_ - 1) / static_cast<long long>(slots_.size());
+    slots_[target % slots_.size()].push_back(placed);
+}
+
+void TimingWheel::ticker_loop() {
+    std::vector<Entry> expired;
+    while (true) {
+        Clock::time_point next_tick;
+        {
+            std::lock_guard<std::mutex> lock(wheel_mutex_);
+            if (active_ == 0) break;
+            next_tick = base_ + tick_ * (current_tick_ + 1);
+        }
+        std::this_thread::sleep_until(next_tick);
+
+        {
+            std::lock_guard<std::mutex> lock(wheel_mutex_);
+            // Catch up on every tick we overslept, in order.
+            long long due = (Clock::now() - base_) / tick_;
+            while (current_tick_ < due) {
+                ++current_tick_;
+                auto& slot = slots_[current_tick_ % slots_.size()];
+                auto waiting = slot.begin();
+                for (auto& entry : slot) {
+                    if (entry.rounds == 0) {
+                        expired.push_back(entry);
+                    } else {
+                        entry.rounds--;
+                        *waiting++ = entry;
+                    }
+                }
+                slot.erase(waiting, slot.end());
+            }
+        }
+
+        if (!expired.empty()) {
+            std::lock_guard<std::mutex> lock(ready_mutex_);
+            ready_.insert(ready_.end(), expired.begin(), expired.end());
+            expired.clear();
+            ready_cv_.notify_all();
+        }
+    }
+}
+
+void TimingWheel::worker_loop() {
+    LatencyRecorder local;
+    std::vector<Entry> batch;
+    std::vector<Entry> again;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(ready_mutex_);
+            ready_cv_.wait(lock, [&] { return stopping_ || !ready_.empty(); });
+            if (ready_.empty()) break;
+            // Take a fair share so one worker does not swallow a large batch.
+            size_t share = std::max<size_t>(1, (ready_.size() + worker_count_ - 1) / worker_count_);
+            batch.assign(ready_.end() - static_cast<long>(share), ready_.end());
+            ready_.resize(ready_.size() - share);
+            if (!ready_.empty()) ready_cv_.notify_one();
+        }
+
+        size_t finished = 0;
+        for (const auto& entry : batch) {
+            auto woke = Clock::now();
+            local.record(std::chrono::duration<double, std::milli>(woke - entry.deadline).count());
+            int delay_ms = tasks_[entry.task]();
+            if (delay_ms == kParked) continue;
+            if (delay_ms < 0) {
+                finished++;
+            } else {
+                again.push_back(Entry{entry.task, 0, Clock::now() + std::chrono::milliseconds(delay_ms)});
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(wheel_mutex_);
+        for (const auto& entry : again) {
+            insert_locked(entry);
+        }
+        active_ -= finished;
+        again.clear();
+    }
+
+    std::lock_guard<std::mutex> lock(wheel_mutex_);
+    latency_.merge(local);
+}
+
+void TimingWheel::run() {
+    {
+        std::lock_guard<std::mutex> lock(wheel_mutex_);
+        base_ = Clock::now();
+        current_tick_ = 0;
+        active_ = tasks_.size();
+        for (size_t task = 0; task < tasks_.size(); ++task) {
+            insert_locked(Entry{task, 0, base_});
+        }
+    }
+    stopping_ = false;
+
+    std::vector<std::thread> workers;
+    for (int i = 0; i < worker_count_; ++i) {
+        workers.emplace_back(&TimingWheel::worker_loop, this);
+    }
+    std::thread ticker(&TimingWheel::ticker_loop, this);
+    ticker.join();
+
+    {
+        std::lock_guard<std::mutex> lock(ready_mutex_);
+        stopping_ = true;
+    }
+    ready_cv_.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+WakeupStats TimingWheel::stats() const {
+    std::lock_guard<std::mutex> lock(wheel_mutex_);
+    WakeupStats stats;
+    stats.wakeups = latency_.count;
+    if (latency_.count == 0) return stats;
+
+    stats.mean_ms = latency_.sum / latency_.count;
+    double variance = latency_.sum_sq / latency_.count - stats.mean_ms * stats.mean_ms;
+    stats.jitter_ms = std::sqrt(std::max(0.0, variance));
+    stats.max_ms = latency_.max;
+
+    long long rank = (latency_.count * 99 + 99) / 100;
+    long long seen = 0;
+    for (int i = 0; i < LatencyRecorder::kBuckets; ++i) {
+        seen += latency_.buckets[i];
+        if (seen >= rank) {
+            stats.p99_ms = (i + 1) / 10.0;
+            break;
+        }
+    }
+    return stats;
+}
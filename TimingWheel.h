@@ -0,0 +1,85 @@
+#ifndef TIMING_WHEEL_H
+#define TIMING_WHEEL_H
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Wakeup latency seen by the tasks the wheel resumed.
+struct WakeupStats {
+    long long wakeups = 0;
+    double mean_ms = 0.0;
+    double jitter_ms = 0.0; // standard deviation of the latency
+    double p99_ms = 0.0;
+    double max_ms = 0.0;
+};
+
+// Hashed timing wheel that paces many resumable tasks on a few threads.
+// A task is a step function returning the wall milliseconds until it wants
+// to run again, -1 once it is finished, or kParked to sleep until someone
+// calls wake() for it. One ticker thread advances the wheel and hands every
+// expired slot to the worker pool as a single batch.
+class TimingWheel {
+public:
+    using Step = std::function<int()>;
+    static const int kParked = -2;
+
+    explicit TimingWheel(int workers, std::chrono::milliseconds tick = std::chrono::milliseconds(1), size_t slots = 512);
+    ~TimingWheel();
+    TimingWheel(const TimingWheel&) = delete;
+    TimingWheel& operator=(const TimingWheel&) = delete;
+
+    size_t add(Step step); // returns the task's index for wake()
+    // Runs a parked task on the next tick. Safe from any thread, including
+    // another task's step.
+    void wake(size_t task);
+    // Runs until every task has finished.
+    void run();
+    WakeupStats stats() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Entry {
+        size_t task;
+        long long rounds;
+        Clock::time_point deadline;
+    };
+
+    struct LatencyRecorder {
+        static const int kBuckets = 1000; // 0.1 ms each, last bucket catches the rest
+        long long count = 0;
+        double sum = 0.0;
+        double sum_sq = 0.0;
+        double max = 0.0;
+        std::vector<long long> buckets = std::vector<long long>(kBuckets, 0);
+
+        void record(double ms);
+        void merge(const LatencyRecorder& other);
+    };
+
+    void insert_locked(const Entry& entry);
+    void ticker_loop();
+    void worker_loop();
+
+    std::vector<Step> tasks_;
+    int worker_count_;
+    Clock::duration tick_;
+    std::vector<std::vector<Entry>> slots_;
+    Clock::time_point base_;
+    long long current_tick_;
+    size_t active_;
+
+    mutable std::mutex wheel_mutex_;
+    std::mutex ready_mutex_;
+    std::condition_variable ready_cv_;
+    std::vector<Entry> ready_;
+    bool stopping_;
+
+    LatencyRecorder latency_;
+};
+
+#endif // TIMING_WHEEL_H
@@ -0,0 +1,61 @@
+#include "TractionModel.h"
+#include <algorithm>
+
+TractionModel::TractionModel(const TractionParams& params) : params_(params) {}
+
+void TractionModel::evaluate(SegmentBatch& batch) const {
+    const size_t count = batch.size();
+    batch.energy_kwh.resize(count);
+
+    const double v_max = params_.max_speed_kmh / 3.6;
+    const double v_max_sq = v_max * v_max;
+    // Highest v^2 a triangular accelerate-then-brake profile reaches per metre.
+    const double reach_per_m = 2.0 * params_.acceleration * params_.braking /
+                               (params_.acceleration + params_.braking);
+    const double empty_mass = params_.empty_mass_kg;
+    const double rider_mass = params_.passenger_mass_kg;
+    const double rotary = params_.rotary_allowance;
+    const double rolling = params_.rolling_resistance;
+    const double drag = params_.drag_coefficient;
+    const double inv_traction = 1.0 / params_.traction_efficiency;
+    const double regen = params_.regen_efficiency;
+    const double joule_to_kwh = 1.0 / 3.6e6;
+
+    const double* distance = batch.distance_m.data();
+    const double* riders = batch.riders.data();
+    double* out = batch.energy_kwh.data();
+
+    for (size_t i = 0; i < count; ++i) {
+        double mass = empty_mass + riders[i] * rider_mass;
+        double v_sq = std::min(distance[i] * reach_per_m, v_max_sq);
+        double kinetic = 0.5 * mass * rotary * v_sq;
+        double resistance = mass * (rolling + drag * v_sq) * distance[i];
+        out[i] = ((kinetic + resistance) * inv_traction - kinetic * regen) * joule_to_kwh;
+    }
+}
+
+double TractionModel::total_kwh(SegmentBatch& batch) const {
+    evaluate(batch);
+    double total = 0.0;
+    for (double kwh : batch.energy_kwh) {
+        total += kwh;
+    }
+    return total;
+}
+
+void FleetSegments::add(double distance_km, int load) {
+    std::lock_guard<std::mutex> lock(lock_);
+    batch_.add(distance_km, load);
+    if (batch_.full()) {
+        kwh_ += model_.total_kwh(batch_);
+        batch_.clear();
+    }
+}
+
+double FleetSegments::drain_kwh() {
+    std::lock_guard<std::mutex> lock(lock_);
+    double kwh = kwh_ + model_.total_kwh(batch_);
+    batch_.clear();
+    kwh_ = 0.0;
+    return kwh;
+}
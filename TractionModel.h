@@ -0,0 +1,81 @@
+#ifndef TRACTION_MODEL_H
+#define TRACTION_MODEL_H
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+// Structure-of-arrays list of station-to-station runs waiting to be costed.
+// One entry per segment a train has driven; riders is the load it carried.
+// energy_kwh is filled in by TractionModel::evaluate().
+struct SegmentBatch {
+    // Owners cost and clear a batch once it holds this many segments, which
+    // keeps the SIMD loop long and the memory fixed however long the run.
+    static const size_t kFlushSize = 4096;
+
+    std::vector<double> distance_m;
+    std::vector<double> riders;
+    std::vector<double> energy_kwh;
+
+    void add(double distance_km, int load) {
+        distance_m.push_back(distance_km * 1000.0);
+        riders.push_back(static_cast<double>(load));
+    }
+    size_t size() const { return distance_m.size(); }
+    bool empty() const { return distance_m.empty(); }
+    bool full() const { return size() >= kFlushSize; }
+    void clear() {
+        distance_m.clear();
+        riders.clear();
+        energy_kwh.clear();
+    }
+};
+
+struct TractionParams {
+    double empty_mass_kg = 170000.0;    // five-car 81-717 set
+    double passenger_mass_kg = 70.0;
+    double rotary_allowance = 1.08;     // wheels and motors add effective inertia
+    double max_speed_kmh = 70.0;
+    double acceleration = 1.0;          // m/s^2
+    double braking = 1.1;               // m/s^2
+    double rolling_resistance = 0.015;  // N per kg
+    double drag_coefficient = 0.00004;  // N per kg per (m/s)^2
+    double traction_efficiency = 0.85;
+    double regen_efficiency = 0.6;      // share of braking energy fed back to the rail
+    double cost_per_kwh = 0.08;
+};
+
+// Per-segment energy: accelerate to the cruise speed (or as fast as the
+// segment allows), cruise, brake, recover part of the kinetic energy.
+class TractionModel {
+public:
+    explicit TractionModel(const TractionParams& params = TractionParams());
+
+    // Net kWh for each segment. One pass over contiguous arrays with no
+    // branches, so the compiler turns it into packed SIMD.
+    void evaluate(SegmentBatch& batch) const;
+    double total_kwh(SegmentBatch& batch) const;
+    double cost(double kwh) const { return kwh * params_.cost_per_kwh; }
+
+private:
+    TractionParams params_;
+};
+
+// The segments of the whole real-time fleet in one batch. Trains append from
+// their own threads; each full batch is costed and cleared, and the kWh add up.
+class FleetSegments {
+public:
+    explicit FleetSegments(const TractionModel& model) : model_(model), kwh_(0.0) {}
+
+    void add(double distance_km, int load);
+    // Costs what is left, returns the kWh since the last drain and starts over.
+    double drain_kwh();
+
+private:
+    const TractionModel& model_;
+    std::mutex lock_;
+    SegmentBatch batch_;
+    double kwh_;
+};
+
+#endif // TRACTION_MODEL_H
@@ -1,5 +1,8 @@
 #include "TrainOperator.h"
 #include "SystemMonitor.h"
+#include "TimingWheel.h"
+#include <array>
+#include <deque>
 #include <random>
 #include <chrono>
 #include <thread>
@@ -9,12 +12,25 @@
 
 extern SystemMonitor monitor;
 
-TrainOperator::TrainOperator(int id, const std::string& route, bool is_forward, const TransitNetwork& network, std::mutex& output)
-    : operator_id_(id), route_name_(route), forward_direction_(is_forward), network_(network), output_mutex_(output) {
+// Each station's platform: the train ID holding it (0 when free) and the
+// trains queued for it in arrival order. Not a mutex held across the dwell,
+// because a platform is claimed and released by different steps that may run
+// on different threads in timing-wheel mode. Release hands the platform to
+// the head of the queue and wakes it, so waiting trains never poll.
+struct PlatformGate {
+    std::mutex lock;
+    int owner = 0;
+    std::deque<TrainOperator*> waiting;
+};
+static std::array<PlatformGate, baku::kStationCount> platform_gates;
+
+TrainOperator::TrainOperator(int id, const std::string& route, bool is_forward, const TransitNetwork& network,
+                             StationQueues& queues, std::mutex& output)
+    : operator_id_(id), route_name_(route), forward_direction_(is_forward), network_(network), queues_(queues), output_mutex_(output),
+    parking_(new Parking()) {
 
     data_.riders = 0;
     data_.max_riders = 500;
-    data_.total_km = 0.0;
 }
 
 TrainOperator::~TrainOperator() {
@@ -22,8 +38,10 @@ TrainOperator::~TrainOperator() {
 
 TrainOperator::TrainOperator(const TrainOperator& other)
     : operator_id_(other.operator_id_), route_name_(other.route_name_),
-    forward_direction_(other.forward_direction_), network_(other.network_),
-    output_mutex_(other.output_mutex_), data_(other.data_) {}
+    forward_direction_(other.forward_direction_), network_(other.network_), queues_(other.queues_),
+    output_mutex_(other.output_mutex_), data_(other.data_),
+    journey_(other.journey_), paced_logging_(other.paced_logging_), kpis_(other.kpis_), segments_(other.segments_),
+    waker_(other.waker_), parking_(new Parking()) {}
 
 TrainOperator& TrainOperator::operator=(const TrainOperator& other) {
     if (this != &other) {
@@ -31,14 +49,21 @@ TrainOperator& TrainOperator::operator=(const TrainOperator& other) {
         route_name_ = other.route_name_;
         forward_direction_ = other.forward_direction_;
         data_ = other.data_;
+        journey_ = other.journey_;
+        paced_logging_ = other.paced_logging_;
+        kpis_ = other.kpis_;
+        segments_ = other.segments_;
+        waker_ = other.waker_;
     }
     return *this;
 }
 
 TrainOperator::TrainOperator(TrainOperator&& other) noexcept
     : operator_id_(other.operator_id_), route_name_(std::move(other.route_name_)),
-    forward_direction_(other.forward_direction_), network_(other.network_),
-    output_mutex_(other.output_mutex_), data_(std::move(other.data_)) {}
+    forward_direction_(other.forward_direction_), network_(other.network_), queues_(other.queues_),
+    output_mutex_(other.output_mutex_), data_(std::move(other.data_)),
+    journey_(std::move(other.journey_)), paced_logging_(other.paced_logging_), kpis_(other.kpis_), segments_(other.segments_),
+    waker_(std::move(other.waker_)), parking_(std::move(other.parking_)) {}
 
 TrainOperator& TrainOperator::operator=(TrainOperator&& other) noexcept {
     if (this != &other) {
@@ -46,6 +71,12 @@ TrainOperator& TrainOperator::operator=(TrainOperator&& other) noexcept {
         route_name_ = std::move(other.route_name_);
         forward_direction_ = other.forward_direction_;
         data_ = std::move(other.data_);
+        journey_ = std::move(other.journey_);
+        paced_logging_ = other.paced_logging_;
+        kpis_ = other.kpis_;
+        segments_ = other.segments_;
+        waker_ = std::move(other.waker_);
+        parking_ = std::move(other.parking_);
     }
     return *this;
 }
@@ -53,14 +84,21 @@ TrainOperator& TrainOperator::operator=(TrainOperator&& other) noexcept {
 void TrainOperator::secure_log(const std::string& message) {
     std::lock_guard<std::mutex> lock(output_mutex_);
     std::cout << message << std::endl;
-    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    if (paced_logging_) std::this_thread::sleep_for(std::chrono::milliseconds(100));
 }
 
-bool TrainOperator::is_high_traffic_time() {
-    auto now = std::chrono::system_clock::now();
-    time_t current_time = std::chrono::system_clock::to_time_t(now);
-    struct tm* time_info = localtime(&current_time);
-    return (time_info->tm_hour >= 7 && time_info->tm_hour < 9) || (time_info->tm_hour >= 17 && time_info->tm_hour < 19);
+// Simulated time of day: the queues' opening time plus wall time since departure, sped up 120x.
+long long TrainOperator::simulated_time_ms() {
+    const long long sim_scale = 120;
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - journey_.sim_start);
+    return queues_.start_ms() + elapsed.count() * sim_scale;
+}
+
+// Simulated ms since the timetable's service start.
+long long TrainOperator::service_time_ms() const {
+    const long long sim_scale = 120;
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - journey_.service_start);
+    return elapsed.count() * sim_scale;
 }
 
 int TrainOperator::estimate_travel_time(double distance) {
@@ -76,197 +114,288 @@ int TrainOperator::estimate_travel_time(double distance) {
     return std::max(250, sim_ms);
 }
 
-void TrainOperator::start_journey() {
-    const auto* routes = network_.routes();
-    if (routes->find(route_name_) == routes->end()) {
-        secure_log("Error: Route " + route_name_ + " not found!");
-        return;
+std::string TrainOperator::line_badge() const {
+    if (route_name_ == "Red") {
+        return "\U0001F534";
+    } else if (route_name_ == "Green") {
+        return "\U0001F7E2";
+    } else if (route_name_ == "Purple") {
+        return "\U0001F7E3";
+    } else if (route_name_ == "Light Green") {
+        return "\U0001F49A";
     }
+    return "";
+}
 
-    const auto& route = routes->at(route_name_);
-    auto stops = *route.stops;
-    if (stops.empty()) {
-        secure_log("Error: No stops in route " + route_name_);
-        return;
-    }
+std::string TrainOperator::stop_name(int index) const {
+    const auto& route = network_.route(journey_.line);
+    return std::string(network_.station_name(route.stop(index)));
+}
 
-    std::string hub = *route.hub;
-    int hub_index = 0;
-    for (std::vector<std::string>::size_type i = 0; i < stops.size(); ++i) {
-        if (stops[i] == hub) {
-            hub_index = static_cast<int>(i);
-            break;
-        }
+// Takes the platform, or joins its queue and returns false.
+bool TrainOperator::claim_platform(int station) {
+    auto& gate = platform_gates[station];
+    std::lock_guard<std::mutex> lock(gate.lock);
+    if (gate.owner == operator_id_) return true; // handed over while parked
+    if (gate.owner != 0) {
+        gate.waiting.push_back(this);
+        return false;
     }
+    gate.owner = operator_id_;
+    return true;
+}
 
-    int current_stop = (hub_index != 0) ? hub_index : (forward_direction_ ? 0 : static_cast<int>(stops.size()) - 1);
-    int direction = forward_direction_ ? 1 : -1;
-    bool is_shuttle = route.is_shuttle;
-    std::map<std::string, int> stop_traffic = {
-        {"Icheri Sheher", 300},{"Memar Acemi 2",300}, {"Sahil", 250}, {"28 May", 400}, {"Ganjlik", 200},
-        {"Nariman Narimanov", 220}, {"Bakmil", 100}, {"Ulduz", 150}, {"Koroglu", 250},
-        {"Kara Karaev", 180}, {"Neftchilar", 150}, {"Khalglar Dostlugu", 200}, {"Ahmedli", 220},
-        {"Azi Aslanov", 180}, {"Jafar Jabbarly", 200}, {"Hatai", 100},
-        {"Khojasan", 80}, {"Avtovagzal", 180}, {"8 Noyabr", 220},
-        {"Nizami", 250}, {"Elmlar Akademiyasy", 200}, {"Inshaatchilar", 180},
-        {"20 January", 220}, {"Memar Ajami", 230}, {"Nasimi", 210},
-        {"Azadlig Prospekti", 190}, {"Darnagul", 170}
-    };
-
-    std::random_device rd;
-    std::mt19937 rng(rd());
-    std::uniform_int_distribution<> rider_rng(0, 100);
-    std::uniform_real_distribution<> fault_rng(0.0, 1.0);
-
-    static std::map<std::string, std::mutex> stop_locks;
-    static std::mutex init_mutex;
+void TrainOperator::release_platform(int station) {
+    auto& gate = platform_gates[station];
+    TrainOperator* next = nullptr;
     {
-        std::lock_guard<std::mutex> lock(init_mutex);
-        for (const auto& stop : stops) {
-            stop_locks.emplace(std::piecewise_construct,
-                               std::forward_as_tuple(stop),
-                               std::forward_as_tuple());
+        std::lock_guard<std::mutex> lock(gate.lock);
+        if (gate.owner != operator_id_) return;
+        gate.owner = 0;
+        if (!gate.waiting.empty()) {
+            next = gate.waiting.front();
+            gate.waiting.pop_front();
+            gate.owner = next->operator_id_;
         }
-        stop_locks.emplace(std::piecewise_construct,
-                           std::forward_as_tuple("Jafar Jabbarly"),
-                           std::forward_as_tuple());
     }
+    if (next) next->wake();
+}
+
+void TrainOperator::wake() {
+    if (waker_) {
+        waker_();
+        return;
+    }
+    std::lock_guard<std::mutex> lock(parking_->lock);
+    parking_->woken = true;
+    parking_->cv.notify_one();
+}
 
-    auto sim_start = std::chrono::steady_clock::now();
-    const auto sim_limit = std::chrono::minutes(10);
-    const auto shift_limit = std::chrono::minutes(5);
-    const double fuel_cost_per_km = 0.1;
-    int shift_number = 1;
-
-    secure_log("🚆 Train " + std::to_string(operator_id_) + " (" + route_name_ + ") departing from " + hub + " 🚉");
-
-    while (std::chrono::steady_clock::now() - sim_start < sim_limit) {
-        auto shift_start = std::chrono::steady_clock::now();
-        std::string shift_message = "⏰ Train " + std::to_string(operator_id_) + " (" + route_name_ + ") shift " +
-                                    std::to_string(shift_number) + " started ";
-        if (route_name_ == "Red") {
-            shift_message += "\U0001F534 \u2705";
-        } else if (route_name_ == "Green") {
-            shift_message += "\U0001F7E2 \u2705";
-        } else if (route_name_ == "Purple") {
-            shift_message += "\U0001F7E3 \u2705";
-        } else if (route_name_ == "Light Green") {
-            shift_message += "\U0001F49A \u2705";
+void TrainOperator::start_journey() {
+    for (int wait_ms = step(); wait_ms >= 0 || wait_ms == TimingWheel::kParked; wait_ms = step()) {
+        if (wait_ms == TimingWheel::kParked) {
+            std::unique_lock<std::mutex> lock(parking_->lock);
+            parking_->cv.wait(lock, [this] { return parking_->woken; });
+            parking_->woken = false;
+        } else if (wait_ms > 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(wait_ms));
         }
-        secure_log(shift_message);
-
-        while (std::chrono::steady_clock::now() - shift_start < shift_limit &&
-               std::chrono::steady_clock::now() - sim_start < sim_limit) {
-            // Проверка корректности current_stop
-            if (current_stop < 0 || current_stop >= static_cast<int>(stops.size())) {
-                secure_log("Error: Invalid stop index " + std::to_string(current_stop));
-                return;
-            }
+    }
+}
 
-            std::unique_lock<std::mutex> stop_lock(stop_locks[stops[current_stop]]);
-
-            std::string next_stop = (current_stop + direction >= 0 && current_stop + direction < static_cast<int>(stops.size())) ?
-                                        stops[current_stop + direction] : "End of Route";
-
-            std::string arrive_message = "🛤️ Train " + std::to_string(operator_id_) + " (" + route_name_ + ") reached " +
-                                         stops[current_stop] + ", heading to " + next_stop + " 🚅";
-            if (route_name_ == "Red") {
-                arrive_message += " \U0001F534";
-            } else if (route_name_ == "Green") {
-                arrive_message += " \U0001F7E2";
-            } else if (route_name_ == "Purple") {
-                arrive_message += " \U0001F7E3";
-            } else if (route_name_ == "Light Green") {
-                arrive_message += " \U0001F49A";
-            }
-            secure_log(arrive_message);
+// Runs the journey up to its next wait and returns how long that wait is in
+// wall milliseconds, -1 once the train has finished, or TimingWheel::kParked
+// while it queues for a platform. The caller does the waiting: start_journey()
+// sleeps, a TimingWheel schedules a wakeup instead.
+int TrainOperator::step() {
+    const long long min_dwell_ms = 20 * 1000; // simulated
+    auto& j = journey_;
+
+    switch (j.phase) {
+    case JourneyState::Begin: {
+        j.line = network_.route_index(route_name_);
+        if (j.line < 0) {
+            secure_log("Error: Route " + route_name_ + " not found!");
+            j.phase = JourneyState::Done;
+            return -1;
+        }
+        const auto& route = network_.route(j.line);
+        if (route.stop_count == 0) {
+            secure_log("Error: No stops in route " + route_name_);
+            j.phase = JourneyState::Done;
+            return -1;
+        }
 
-            // Проверка stop_traffic
-            if (stop_traffic.find(stops[current_stop]) == stop_traffic.end()) {
-                secure_log("Error: Stop " + stops[current_stop] + " not found in stop_traffic!");
-                return;
+        int hub_index = 0;
+        for (int i = 0; i < route.stop_count; ++i) {
+            if (route.stop(i) == route.hub) {
+                hub_index = i;
+                break;
             }
-            if (stop_traffic[stops[current_stop]] == 0) {
-                secure_log("Error: Zero traffic value for stop " + stops[current_stop]);
-                return;
+        }
+        j.current_stop = (hub_index != 0) ? hub_index : (forward_direction_ ? 0 : route.stop_count - 1);
+        j.direction = forward_direction_ ? 1 : -1;
+        if (j.timetable) {
+            if (j.timetable_train >= j.timetable->trains_in_service) {
+                secure_log("🅿️ Train " + std::to_string(operator_id_) + " (" + route_name_ + ") not needed by the timetable, stays in the depot");
+                j.phase = JourneyState::Done;
+                return -1;
             }
+            j.current_stop = j.timetable->start_stop;
+            j.direction = j.timetable->start_direction;
+        }
+        j.rng.seed(std::random_device()());
+        j.sim_start = std::chrono::steady_clock::now();
 
-            int riders_off = std::min(data_.riders, rider_rng(rng));
-            int riders_on = rider_rng(rng) % stop_traffic[stops[current_stop]];
-            riders_on = is_high_traffic_time() ? riders_on * 2 : riders_on;
+        secure_log("🚆 Train " + std::to_string(operator_id_) + " (" + route_name_ + ") departing from " +
+                   std::string(network_.station_name(route.hub)) + " 🚉");
+        j.phase = JourneyState::ShiftStart;
+        return 0;
+    }
 
+    case JourneyState::ShiftStart:
+        j.shift_start = std::chrono::steady_clock::now();
+        secure_log("⏰ Train " + std::to_string(operator_id_) + " (" + route_name_ + ") shift " +
+                   std::to_string(j.shift_number) + " started " + line_badge() + " \u2705");
+        j.phase = JourneyState::Arrive;
+        return 0;
+
+    case JourneyState::Arrive: {
+        auto now = std::chrono::steady_clock::now();
+        const auto& route = network_.route(j.line);
+        const int stop_count = route.stop_count;
+        if (now - j.shift_start >= j.shift_limit || now - j.sim_start >= j.sim_limit) {
+            // The platform may have been handed over while the train was parked.
+            if (j.current_stop >= 0 && j.current_stop < stop_count) release_platform(route.stop(j.current_stop));
+            j.phase = JourneyState::ShiftEnd;
+            return 0;
+        }
 
-       /*     secure_log("Debug: riders_off=" + std::to_string(riders_off) + ", riders_on=" + std::to_string(riders_on) +
-                       ", data_.riders=" + std::to_string(data_.riders) + ", stop=" + stops[current_stop]);*/
+        // Проверка корректности current_stop
+        if (j.current_stop < 0 || j.current_stop >= stop_count) {
+            secure_log("Error: Invalid stop index " + std::to_string(j.current_stop));
+            j.phase = JourneyState::Done;
+            return -1;
+        }
 
-            monitor.record_passengers(riders_on, riders_off);
-            data_.riders = std::min(data_.max_riders, data_.riders - riders_off + riders_on);
+        if (j.timetable && j.visit == 0) {
+            // Stay in the depot until the first call, so the platform is free for trains due earlier.
+            long long now_ms = service_time_ms();
+            long long enter_ms = j.timetable->departure(j.timetable_train, 0) - j.timetable->first_departure_ms;
+            if (now_ms < enter_ms) return static_cast<int>((enter_ms - now_ms + 119) / 120);
+        }
 
-            std::string passenger_message = "👥 Train " + std::to_string(operator_id_) + " (" + route_name_ + "): " +
-                                            std::to_string(riders_off) + " alighted 🚶, " + std::to_string(riders_on) +
-                                            " boarded 🧳, current: " + std::to_string(data_.riders) + " passengers";
-            if (route_name_ == "Red") {
-                passenger_message += " \U0001F534";
-            } else if (route_name_ == "Green") {
-                passenger_message += " \U0001F7E2";
-            } else if (route_name_ == "Purple") {
-                passenger_message += " \U0001F7E3";
-            } else if (route_name_ == "Light Green") {
-                passenger_message += " \U0001F49A";
-            }
-            secure_log(passenger_message);
-
-            int stop_duration = (20 + (rand() % 21)) * 1000 / 120;
-            std::this_thread::sleep_for(std::chrono::milliseconds(stop_duration));
-
-            secure_log("🚪 Train " + std::to_string(operator_id_) + " (" + route_name_ + ") leaving " + stops[current_stop] + " 👋");
-
-            stop_lock.unlock();
-
-            if (current_stop + direction >= 0 && current_stop + direction < static_cast<int>(stops.size())) {
-                double distance = network_.distance_between(stops[current_stop], stops[current_stop + direction]);
-                if (distance <= 0 || std::isnan(distance) || std::isinf(distance)) {
-                    secure_log("Error: Invalid distance between " + stops[current_stop] + " and " + stops[current_stop + direction]);
-                    return;
-                }
-                data_.total_km += distance;
-                int travel_time = estimate_travel_time(distance);
-                secure_log("🚄 Train " + std::to_string(operator_id_) + " traveling to " + stops[current_stop + direction] +
-                           " (" + std::to_string(travel_time / 1000.0) + "s) 🕒");
-                std::this_thread::sleep_for(std::chrono::milliseconds(travel_time));
-            }
+        // Nothing may touch the train after it is queued: the release can resume it on another thread at once.
+        if (!claim_platform(route.stop(j.current_stop))) return TimingWheel::kParked;
+
+        std::string next_stop = (j.current_stop + j.direction >= 0 && j.current_stop + j.direction < stop_count) ?
+                                    stop_name(j.current_stop + j.direction) : "End of Route";
+        secure_log("🛤️ Train " + std::to_string(operator_id_) + " (" + route_name_ + ") reached " +
+                   stop_name(j.current_stop) + ", heading to " + next_stop + " 🚅 " + line_badge());
+
+        // Riders are bound for any of the stops still ahead, this one included.
+        int stops_ahead = j.direction > 0 ? stop_count - 1 - j.current_stop : j.current_stop;
+        int riders_off = data_.riders / (stops_ahead + 1);
+        int free_space = data_.max_riders - (data_.riders - riders_off);
+        long long now_ms = simulated_time_ms();
+        auto boarding = queues_.board(j.line, route.stop(j.current_stop), now_ms, free_space);
+        int riders_on = boarding.boarded;
+
+        monitor.record_passengers(riders_on, riders_off);
+        if (boarding.denied > 0) monitor.record_denied(boarding.denied);
+        if (kpis_ && riders_off > 0) {
+            double since = data_.onboard_since_ms / data_.riders;
+            double waited = data_.onboard_wait_ms / data_.riders;
+            kpis_->record(j.line, Kpi::Journey, j.current_stop, static_cast<unsigned long long>(now_ms - since + waited), riders_off);
+            data_.onboard_since_ms -= since * riders_off;
+            data_.onboard_wait_ms -= waited * riders_off;
+        }
+        if (kpis_ && riders_on > 0) {
+            kpis_->record(j.line, Kpi::Wait, j.current_stop, static_cast<unsigned long long>(boarding.mean_wait_ms), riders_on);
+            data_.onboard_since_ms += static_cast<double>(now_ms) * riders_on;
+            data_.onboard_wait_ms += boarding.mean_wait_ms * riders_on;
+        }
+        data_.riders = data_.riders - riders_off + riders_on;
+        j.arrived_ms = now_ms;
+
+        secure_log("👥 Train " + std::to_string(operator_id_) + " (" + route_name_ + "): " +
+                   std::to_string(riders_off) + " alighted 🚶, " + std::to_string(riders_on) +
+                   " boarded 🧳, current: " + std::to_string(data_.riders) + " passengers " + line_badge());
+
+        j.phase = JourneyState::Depart;
+        if (j.timetable) {
+            // Hold until the scheduled departure; a late train only keeps the minimum dwell.
+            long long now_ms = service_time_ms();
+            long long due_ms = j.timetable->departure(j.timetable_train, j.visit);
+            return static_cast<int>(std::max(min_dwell_ms, due_ms - now_ms) / 120);
+        }
+        std::uniform_int_distribution<> dwell_rng(20, 40);
+        return dwell_rng(j.rng) * 1000 / 120;
+    }
 
-            if (fault_rng(rng) < 0.01) {
-                secure_log("⚠️ Train " + std::to_string(operator_id_) + " (" + route_name_ + ") experienced a fault 🛠️, cost: 300 bucks 💸");
-                monitor.log_incident_cost(50.0);
-            }
+    case JourneyState::Depart: {
+        const auto& route = network_.route(j.line);
+        secure_log("🚪 Train " + std::to_string(operator_id_) + " (" + route_name_ + ") leaving " + stop_name(j.current_stop) + " 👋");
+        release_platform(route.stop(j.current_stop));
+        if (j.timetable) {
+            long long now_ms = service_time_ms();
+            j.adherence->record(now_ms - j.timetable->departure(j.timetable_train, j.visit));
+            j.visit++;
+        }
 
-            current_stop += direction;
-            if (current_stop < 0 || current_stop >= static_cast<int>(stops.size())) {
-                direction = -direction;
-                current_stop += 2 * direction;
-            }
+        // Turn back at the end of the line so the run back is driven too.
+        if (j.current_stop + j.direction < 0 || j.current_stop + j.direction >= route.stop_count) {
+            j.direction = -j.direction;
+        }
+        if (kpis_) {
+            long long now_ms = simulated_time_ms();
+            long long headway = kpis_->departed(j.line, j.current_stop, j.direction, now_ms);
+            if (headway >= 0) kpis_->record(j.line, Kpi::Headway, j.current_stop, static_cast<unsigned long long>(headway));
+            kpis_->record(j.line, Kpi::Dwell, j.current_stop, static_cast<unsigned long long>(std::max(0LL, now_ms - j.arrived_ms)));
+            kpis_->record(j.line, Kpi::LoadFactor, j.current_stop, static_cast<unsigned long long>(data_.riders * 100 / data_.max_riders));
+        }
+        j.phase = JourneyState::Travelled;
+        if (j.current_stop + j.direction < 0 || j.current_stop + j.direction >= route.stop_count) {
+            return 0;
+        }
+        double distance = network_.distance_between(route.stop(j.current_stop), route.stop(j.current_stop + j.direction));
+        if (distance <= 0 || std::isnan(distance) || std::isinf(distance)) {
+            secure_log("Error: Invalid distance between " + stop_name(j.current_stop) + " and " + stop_name(j.current_stop + j.direction));
+            j.phase = JourneyState::Done;
+            return -1;
+        }
+        if (segments_) segments_->add(distance, data_.riders);
+        int travel_time = estimate_travel_time(distance);
+        secure_log("🚄 Train " + std::to_string(operator_id_) + " traveling to " + stop_name(j.current_stop + j.direction) +
+                   " (" + std::to_string(travel_time / 1000.0) + "s) 🕒");
+        return travel_time;
+    }
+
+    case JourneyState::Travelled: {
+        std::uniform_real_distribution<> fault_rng(0.0, 1.0);
+        if (fault_rng(j.rng) < 0.01) {
+            secure_log("⚠️ Train " + std::to_string(operator_id_) + " (" + route_name_ + ") experienced a fault 🛠️, cost: 300 bucks 💸");
+            monitor.log_incident_cost(50.0);
         }
 
-        monitor.log_energy_cost(data_.total_km * fuel_cost_per_km);
+        const int stop_count = network_.route(j.line).stop_count;
+        j.current_stop += j.direction;
+        if (j.current_stop < 0 || j.current_stop >= stop_count) {
+            j.direction = -j.direction;
+            j.current_stop += 2 * j.direction;
+        }
+        j.phase = JourneyState::Arrive;
+        return 0;
+    }
 
-        if (!is_shuttle) {
+    case JourneyState::ShiftEnd: {
+        const auto& route = network_.route(j.line);
+        if (!route.is_shuttle) {
             secure_log("🏁 Train " + std::to_string(operator_id_) + " (" + route_name_ + ") shift " +
-                       std::to_string(shift_number) + " completed, returned to " + hub + " 🏠");
+                       std::to_string(j.shift_number) + " completed, returned to " + std::string(network_.station_name(route.hub)) + " 🏠");
         } else {
-            std::unique_lock<std::mutex> lock(stop_locks[stops[current_stop]]);
             secure_log("🏁 Train " + std::to_string(operator_id_) + " (" + route_name_ + ") shift " +
-                       std::to_string(shift_number) + " completed, stationed at " + stops[current_stop] + " 🚉");
+                       std::to_string(j.shift_number) + " completed, stationed at " + stop_name(j.current_stop) + " 🚉");
         }
-        shift_number++;
+        j.shift_number++;
+        j.phase = (std::chrono::steady_clock::now() - j.sim_start < j.sim_limit) ? JourneyState::ShiftStart : JourneyState::Finish;
+        return 0;
     }
 
-    monitor.log_energy_cost(data_.total_km * fuel_cost_per_km);
+    case JourneyState::Finish: {
+        const auto& route = network_.route(j.line);
+        if (!route.is_shuttle) {
+            secure_log("🎉 Train " + std::to_string(operator_id_) + " (" + route_name_ + ") simulation ended, at " +
+                       std::string(network_.station_name(route.hub)) + " 🏁");
+        } else {
+            secure_log("🎉 Train " + std::to_string(operator_id_) + " (" + route_name_ + ") simulation ended, at " + stop_name(j.current_stop) + " 🏁");
+        }
+        j.phase = JourneyState::Done;
+        return -1;
+    }
 
-    if (!is_shuttle) {
-        secure_log("🎉 Train " + std::to_string(operator_id_) + " (" + route_name_ + ") simulation ended, at " + hub + " 🏁");
-    } else {
-        std::unique_lock<std::mutex> lock(stop_locks[stops[current_stop]]);
-        secure_log("🎉 Train " + std::to_string(operator_id_) + " (" + route_name_ + ") simulation ended, at " + stops[current_stop] + " 🏁");
+    case JourneyState::Done:
+        break;
     }
+    return -1;
 }
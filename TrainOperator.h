@@ -4,38 +4,108 @@
 #include <string>
 #include <mutex>
 #include "TransitNetwork.h"
+#include "TractionModel.h"
+#include "StationDemand.h"
+#include "Timetable.h"
+#include "KpiHistogram.h"
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <random>
 
 struct TrainData {
     int riders;
-    double total_km;
     int max_riders;
+    double onboard_since_ms; // summed over the riders on board
+    double onboard_wait_ms;
 
-    TrainData() : riders(0), total_km(0.0), max_riders(500) {}
+    TrainData() : riders(0), max_riders(500), onboard_since_ms(0.0), onboard_wait_ms(0.0) {}
 };
 
 class TrainOperator {
 public:
-    TrainOperator(int id, const std::string& route, bool is_forward, const TransitNetwork& network, std::mutex& output);
+    TrainOperator(int id, const std::string& route, bool is_forward, const TransitNetwork& network,
+                  StationQueues& queues, std::mutex& output);
     ~TrainOperator();
     TrainOperator(const TrainOperator& other);
     TrainOperator& operator=(const TrainOperator& other);
     TrainOperator(TrainOperator&& other) noexcept;
     TrainOperator& operator=(TrainOperator&& other) noexcept;
 
-    void return_to_hub( const std::vector<std::string>& stops, int current_stop, const TransitNetwork::Route& route);
     void start_journey();
+    int step();
+    void set_paced_logging(bool paced) { paced_logging_ = paced; }
+    void set_kpis(KpiBoard& kpis) { kpis_ = &kpis; }
+    void set_segments(FleetSegments& segments) { segments_ = &segments; }
+    // How to resume the train after step() parked it waiting for a platform.
+    // Without one, start_journey() sleeps until the platform is handed over.
+    void set_waker(std::function<void()> waker) { waker_ = std::move(waker); }
+    void set_run_length(std::chrono::milliseconds length) {
+        journey_.sim_limit = length;
+        journey_.shift_limit = length / 2;
+    }
+    // Dispatch by the timetable instead of random dwells; train is this one's
+    // slot in it. Schedule times count from service_start, shared by the
+    // whole fleet. Both objects must outlive the journey.
+    void follow_timetable(const LineTimetable& timetable, int train, ScheduleAdherence& adherence,
+                          std::chrono::steady_clock::time_point service_start) {
+        journey_.timetable = &timetable;
+        journey_.timetable_train = train;
+        journey_.adherence = &adherence;
+        journey_.service_start = service_start;
+    }
     bool running;
 private:
+    struct JourneyState {
+        enum Phase { Begin, ShiftStart, Arrive, Depart, Travelled, ShiftEnd, Finish, Done };
+        Phase phase = Begin;
+        int line = -1;
+        int current_stop = 0;
+        int direction = 1;
+        int shift_number = 1;
+        std::chrono::milliseconds sim_limit = std::chrono::minutes(10);
+        std::chrono::milliseconds shift_limit = std::chrono::minutes(5);
+        std::chrono::steady_clock::time_point sim_start;
+        std::chrono::steady_clock::time_point shift_start;
+        std::chrono::steady_clock::time_point service_start;
+        std::mt19937 rng;
+        const LineTimetable* timetable = nullptr;
+        int timetable_train = 0;
+        long long visit = 0; // timetable visits departed so far
+        long long arrived_ms = 0;
+        ScheduleAdherence* adherence = nullptr;
+    };
+
     void secure_log(const std::string& message);
-    bool is_high_traffic_time();
+    long long simulated_time_ms();
+    long long service_time_ms() const;
+    std::string line_badge() const;
+    std::string stop_name(int index) const;
     int estimate_travel_time(double distance);
+    bool claim_platform(int station);
+    void release_platform(int station);
+    void wake();
 
     int operator_id_;
     std::string route_name_;
     bool forward_direction_;
     const TransitNetwork& network_;
+    StationQueues& queues_;
     std::mutex& output_mutex_;
     TrainData data_;
+    JourneyState journey_;
+    bool paced_logging_ = true;
+    KpiBoard* kpis_ = nullptr;
+    FleetSegments* segments_ = nullptr;
+    std::function<void()> waker_;
+
+    struct Parking {
+        std::mutex lock;
+        std::condition_variable cv;
+        bool woken = false;
+    };
+    std::unique_ptr<Parking> parking_;
 };
 
 #endif
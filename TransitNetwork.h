@@ -1,45 +1,32 @@
 #ifndef TRANSIT_NETWORK_H
 #define TRANSIT_NETWORK_H
 
-#include <map>
-#include <string>
-#include <vector>
-#include <mutex>
+#include "BakuNetwork.h"
+#include <string_view>
 
+// Read-only view of the metro network. The Baku network is compiled into the
+// tables of BakuNetwork.h, so this class has no state and copies are free.
+// Stations are addressed by ID; names are only resolved at the edges.
 class TransitNetwork {
 public:
-    struct Route {
-        std::vector<std::string>* stops;
-        std::string* hub;
-        mutable std::vector<std::mutex> platform_locks;
-        mutable std::vector<std::mutex> track_locks;
-        size_t platform_count=platform_locks.size();
-        size_t track_count= track_locks.size();
-        bool is_shuttle;
+    using Route = baku::Line;
 
-        Route(const std::vector<std::string>& s, const std::string& h, size_t platform_count,size_t  track_count, bool shuttle = false);
-        ~Route();
-        Route(const Route&);
-        Route& operator=(const Route&);
-        Route(Route&&) noexcept;
-        Route& operator=(Route&&) noexcept;
-    };
+    int route_count() const { return baku::kLineCount; }
+    const Route& route(int index) const { return baku::kLines[index]; }
+    const Route* find_route(std::string_view name) const;
+    int route_index(std::string_view name) const;
 
-    TransitNetwork();
-    ~TransitNetwork();
-    TransitNetwork(const TransitNetwork&);
-    TransitNetwork& operator=(const TransitNetwork&);
-    TransitNetwork(TransitNetwork&&) noexcept;
-    TransitNetwork& operator=(TransitNetwork&&) noexcept;
-    void return_to_hub(const std::vector<std::string>& stops, int current_stop, const TransitNetwork::Route& route);
-    const std::map<std::string, Route>* routes() const;
-    double distance_between(const std::string& start, const std::string& end) const;
+    int station_count() const { return baku::kStationCount; }
+    int station_id(std::string_view name) const { return baku::station_id(name); }
+    std::string_view station_name(int station) const { return baku::kStations[station].name; }
 
-private:
-    void setup_routes();
-    void setup_distances();
-    std::map<std::string, Route>* routes_;
-    std::map<std::pair<std::string, std::string>, double>* stop_distances_;
+    double distance_between(int start, int end) const { return baku::kDistances[start][end]; }
+    double distance_between(std::string_view start, std::string_view end) const;
+    int passenger_traffic(int station) const { return baku::kStations[station].traffic; }
+    int passenger_traffic(std::string_view stop) const;
+    // Base traffic of one line's platform: an interchange's riders are shared
+    // evenly between the lines calling there.
+    double platform_traffic(int station) const;
 };
 
 #endif
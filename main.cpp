@@ -1,10 +1,91 @@
 #include "SimulationManager.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
 
+static void print_usage(const char* program) {
+    std::cout << "Usage: " << program << " [--event] [--parallel] [--shards N] [--wheel N] [--minutes M]\n"
+              << "       [--timetable S|auto] [--search-timetables] [--seed N] [--hours H] [--trains R,G,P,L]\n"
+              << "       [--kpi-out PREFIX] [--kpi-every H]\n"
+              << "  --event      run the discrete-event simulation instead of real-time threads\n"
+              << "  --parallel   event-driven run with one thread per line\n"
+              << "  --shards N   event-driven run split across N local worker processes\n"
+              << "  --wheel N    real-time run paced by a timing wheel on N worker threads\n"
+              << "  --minutes M  wall-clock minutes for the real-time run\n"
+              << "  --timetable  real-time trains follow a timetable with an S-second headway, or the best found\n"
+              << "  --search-timetables  score candidate timetables for the fleet, print the best and exit\n"
+              << "  --seed N     random seed for the event-driven run\n"
+              << "  --hours H    simulated hours for the event-driven run\n"
+              << "  --trains     train counts per line, skips the interactive prompt\n"
+              << "  --kpi-out    write KPI histograms to PREFIX.csv and PREFIX.kpi at the end of the run\n"
+              << "  --kpi-every  with --kpi-out, also write them every H simulated hours\n";
+}
 
-int main() {
+static bool parse_options(int argc, char* argv[], SimulationOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (std::strcmp(arg, "--event") == 0) {
+            options.event_driven = true;
+        } else if (std::strcmp(arg, "--parallel") == 0) {
+            options.event_driven = true;
+            options.parallel = true;
+        } else if (std::strcmp(arg, "--shards") == 0 && has_value) {
+            options.event_driven = true;
+            options.shards = std::atoi(argv[++i]);
+            if (options.shards <= 0) return false;
+        } else if (std::strcmp(arg, "--wheel") == 0 && has_value) {
+            options.wheel_workers = std::atoi(argv[++i]);
+            if (options.wheel_workers <= 0) return false;
+        } else if (std::strcmp(arg, "--minutes") == 0 && has_value) {
+            options.realtime_minutes = std::atof(argv[++i]);
+            if (options.realtime_minutes <= 0) return false;
+        } else if (std::strcmp(arg, "--timetable") == 0 && has_value) {
+            const char* value = argv[++i];
+            options.timetable = true;
+            if (std::strcmp(value, "auto") == 0) {
+                options.timetable_auto = true;
+            } else {
+                char* end = nullptr;
+                options.timetable_headway_s = std::strtod(value, &end);
+                if (end == value || *end != '\0') return false;
+                if (!std::isfinite(options.timetable_headway_s) || options.timetable_headway_s <= 0) return false;
+            }
+        } else if (std::strcmp(arg, "--search-timetables") == 0) {
+            options.search_timetables = true;
+        } else if (std::strcmp(arg, "--kpi-out") == 0 && has_value) {
+            options.kpi_prefix = argv[++i];
+        } else if (std::strcmp(arg, "--kpi-every") == 0 && has_value) {
+            options.kpi_every_hours = std::atof(argv[++i]);
+            if (options.kpi_every_hours <= 0) return false;
+        } else if (std::strcmp(arg, "--seed") == 0 && has_value) {
+            options.seed = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(arg, "--hours") == 0 && has_value) {
+            options.sim_hours = std::atof(argv[++i]);
+            if (options.sim_hours <= 0) return false;
+        } else if (std::strcmp(arg, "--trains") == 0 && has_value) {
+            int* t = options.preset_trains;
+            if (std::sscanf(argv[++i], "%d,%d,%d,%d", &t[0], &t[1], &t[2], &t[3]) != 4) return false;
+            for (int j = 0; j < 4; ++j) {
+                if (t[j] < 0) return false;
+            }
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
 
+int main(int argc, char* argv[]) {
+    SimulationOptions options;
+    if (!parse_options(argc, argv, options)) {
+        print_usage(argv[0]);
+        return 1;
+    }
 
-    SimulationManager manager;
+    SimulationManager manager(options);
     manager.start_operations();
 
     return 0;
@@ -11,15 +11,36 @@ CONFIG += c++17
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
 SOURCES += \
+    EventSimulation.cpp \
+    KpiExport.cpp \
+    KpiHistogram.cpp \
+    ShardCoordinator.cpp \
+    SharedMemoryTransport.cpp \
     SimulationManager.cpp \
+    StationDemand.cpp \
     SystemMonitor.cpp \
+    TimingWheel.cpp \
+    Timetable.cpp \
+    TractionModel.cpp \
     TrainOperator.cpp \
     TransitNetwork.cpp \
     main.cpp
 
 HEADERS += \
+    BakuNetwork.h \
+    EventSimulation.h \
+    KpiExport.h \
+    KpiHistogram.h \
+    Mailbox.h \
+    ShardCoordinator.h \
+    ShardTransport.h \
+    SharedMemoryTransport.h \
     SimulationManager.h \
+    StationDemand.h \
     SystemMonitor.h \
+    TimingWheel.h \
+    Timetable.h \
+    TractionModel.h \
     TrainOperator.h \
     TransitNetwork.h
 
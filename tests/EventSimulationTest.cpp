@@ -0,0 +1,115 @@
+#include "EventSimulation.h"
+#include "ShardCoordinator.h"
+#include "TestSupport.h"
+#include <string>
+
+// Runs the same seed sequentially, with one thread per line and across
+// worker processes, and checks that every mode ends in the same state, then
+// that idle lines do not collect platform requests.
+
+namespace {
+
+struct Outcome {
+    unsigned long long digest = 0;
+    std::vector<EventSimulation::LineResult> lines;
+    long long riders = 0;
+    long long alighted = 0;
+    long long active_riders = 0;
+    long long denied = 0;
+    double energy_kwh = 0.0;
+    double incident_expense = 0.0;
+    std::vector<unsigned long long> kpi_counts;
+};
+
+// shards == 0 runs in process.
+Outcome run(const TransitNetwork& network, bool parallel, int shards) {
+    EventSimulation::Config config;
+    config.seed = 7;
+    config.duration_ms = 3LL * 3600 * 1000;
+    config.parallel = parallel;
+    EventSimulation simulation(network, config);
+    simulation.add_trains("Red", 6);
+    simulation.add_trains("Green", 6);
+    simulation.add_trains("Purple", 3);
+    simulation.add_trains("Light Green", 2);
+
+    Outcome outcome;
+    if (shards > 0) {
+        ShardCoordinator coordinator(simulation, shards);
+        expect(coordinator.run(), "sharded run: " + coordinator.error());
+    } else {
+        simulation.run();
+    }
+
+    outcome.digest = simulation.digest();
+    outcome.lines = simulation.results();
+    SystemMonitor monitor;
+    simulation.merge_into(monitor);
+    outcome.riders = monitor.total_riders();
+    outcome.alighted = monitor.total_alighted();
+    outcome.active_riders = monitor.active_riders();
+    outcome.denied = monitor.denied_boardings();
+    outcome.energy_kwh = monitor.energy_kwh();
+    outcome.incident_expense = monitor.incident_expense();
+    for (const LineKpis* kpis : simulation.line_kpis()) {
+        for (int kpi = 0; kpi < kKpiCount; ++kpi) {
+            outcome.kpi_counts.push_back(kpis->line_total(static_cast<Kpi>(kpi)).count());
+        }
+    }
+    return outcome;
+}
+
+void expect_same(const Outcome& expected, const Outcome& actual, const std::string& mode) {
+    expect(actual.digest == expected.digest, mode + ": digest");
+    expect(actual.lines.size() == expected.lines.size(), mode + ": line count");
+    for (size_t i = 0; i < expected.lines.size() && i < actual.lines.size(); ++i) {
+        const auto& a = actual.lines[i];
+        const auto& e = expected.lines[i];
+        expect(a.events == e.events && a.arrivals == e.arrivals && a.digest == e.digest, mode + ": " + e.line + " events");
+        expect(a.transfers_in == e.transfers_in && a.transfers_out == e.transfers_out, mode + ": " + e.line + " transfers");
+    }
+    expect(actual.riders == expected.riders, mode + ": riders");
+    expect(actual.alighted == expected.alighted && actual.active_riders == expected.active_riders,
+           mode + ": riders alighted and on board");
+    expect(actual.denied == expected.denied, mode + ": denied boardings");
+    expect(actual.energy_kwh == expected.energy_kwh, mode + ": energy");
+    expect(actual.incident_expense == expected.incident_expense, mode + ": incidents");
+    expect(actual.kpi_counts == expected.kpi_counts, mode + ": KPI sample counts");
+}
+
+// A line without trains never claims its platforms, so nobody may keep
+// filing requests with it.
+void expect_bounded_requests(const TransitNetwork& network) {
+    EventSimulation::Config config;
+    config.seed = 7;
+    config.duration_ms = 10LL * 3600 * 1000;
+    EventSimulation simulation(network, config);
+    simulation.add_trains("Red", 10);
+    simulation.add_trains("Green", 0);
+    simulation.add_trains("Purple", 1);
+    simulation.add_trains("Light Green", 1);
+    simulation.run();
+
+    // At most one open request per train on each line that calls at its stop.
+    size_t bound = 12 * static_cast<size_t>(simulation.line_count());
+    expect(simulation.pending_platform_requests() <= bound,
+           "line without trains: " + std::to_string(simulation.pending_platform_requests()) + " pending platform requests");
+}
+
+} // namespace
+
+int main() {
+    TransitNetwork network;
+    Outcome sequential = run(network, false, 0);
+    expect(sequential.riders > 0, "sequential run carried no riders");
+
+    expect_same(sequential, run(network, false, 0), "repeat");
+    expect_same(sequential, run(network, true, 0), "parallel");
+#if defined(__unix__) || defined(__APPLE__)
+    expect_same(sequential, run(network, false, 2), "2 shards");
+    expect_same(sequential, run(network, false, 4), "4 shards");
+#endif
+    expect_bounded_requests(network);
+
+    return finish("event simulation modes agree");
+}
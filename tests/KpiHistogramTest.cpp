@@ -0,0 +1,171 @@
+#include "KpiHistogram.h"
+#include "SharedMemoryTransport.h"
+#include "TestSupport.h"
+#include <cmath>
+#include <random>
+#include <string>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/wait.h>
+#include <unistd.h>
+#define SUBWAY_HAS_FORK 1
+#endif
+
+// Bucket layout, percentile accuracy, merging, and KPI chunks surviving a
+// trip over the shard rings.
+
+namespace {
+
+bool within(double actual, double expected, double relative) {
+    return std::fabs(actual - expected) <= expected * relative;
+}
+
+bool same(const KpiHistogram& a, const KpiHistogram& b) {
+    if (a.count() != b.count() || a.min() != b.min() || a.max() != b.max()) return false;
+    for (int i = 0; i < KpiHistogram::kBucketCount; ++i) {
+        if (a.bucket(i) != b.bucket(i)) return false;
+    }
+    return true;
+}
+
+KpiHistogram random_histogram(unsigned seed, int samples) {
+    std::mt19937 rng(seed);
+    std::lognormal_distribution<> value(10.0, 2.0);
+    KpiHistogram histogram;
+    for (int i = 0; i < samples; ++i) {
+        histogram.record(static_cast<unsigned long long>(value(rng)));
+    }
+    return histogram;
+}
+
+void test_bucket_bounds() {
+    for (int i = 0; i < KpiHistogram::kBucketCount; ++i) {
+        unsigned long long low = KpiHistogram::bucket_low(i);
+        unsigned long long width = KpiHistogram::bucket_width(i);
+        std::string name = "bucket " + std::to_string(i);
+        expect(KpiHistogram::bucket_of(low) == i, name + " holds its lowest value");
+        expect(KpiHistogram::bucket_of(low + width - 1) == i, name + " holds its highest value");
+        if (i + 1 < KpiHistogram::kBucketCount) {
+            expect(KpiHistogram::bucket_low(i + 1) == low + width, name + " is followed without a gap");
+        }
+        if (i >= 2 * KpiHistogram::kSubBuckets) {
+            expect(width * KpiHistogram::kSubBuckets <= low, name + " is narrower than 1/32 of its values");
+        } else {
+            expect(width == 1, name + " is exact");
+        }
+    }
+    expect(KpiHistogram::bucket_of(~0ULL) == KpiHistogram::kBucketCount - 1, "huge values clamp to the last bucket");
+}
+
+void test_percentiles() {
+    KpiHistogram histogram;
+    expect(histogram.percentile(50) == 0 && histogram.min() == 0 && histogram.max() == 0, "empty histogram reads 0");
+
+    for (unsigned long long value = 1; value <= 100000; ++value) {
+        histogram.record(value);
+    }
+    expect(histogram.count() == 100000, "count");
+    expect(histogram.min() == 1 && histogram.max() == 100000, "exact min and max");
+    expect(histogram.percentile(0) == 1, "p0 is the min");
+    expect(histogram.percentile(100) <= histogram.max(), "p100 never passes the max");
+    expect(within(static_cast<double>(histogram.percentile(50)), 50000, 1.0 / 32), "p50 within 3%");
+    expect(within(static_cast<double>(histogram.percentile(90)), 90000, 1.0 / 32), "p90 within 3%");
+    expect(within(static_cast<double>(histogram.percentile(99)), 99000, 1.0 / 32), "p99 within 3%");
+    expect(within(static_cast<double>(histogram.percentile(100)), 100000, 1.0 / 32), "p100 within 3%");
+    expect(within(histogram.mean(), 50000.5, 0.01), "mean within 1%");
+
+    KpiHistogram single;
+    single.record(1234567, 5);
+    expect(single.percentile(1) == 1234567 && single.percentile(99) == 1234567, "one value reads back exactly");
+
+    histogram.clear();
+    expect(histogram.empty() && histogram.min() == 0 && histogram.max() == 0, "clear resets min and max");
+}
+
+void test_merge() {
+    KpiHistogram a = random_histogram(1, 5000);
+    KpiHistogram b = random_histogram(2, 3000);
+    KpiHistogram c = random_histogram(3, 7000);
+
+    KpiHistogram left = a;
+    left.merge(b);
+    left.merge(c);
+    KpiHistogram right_tail = b;
+    right_tail.merge(c);
+    KpiHistogram right = a;
+    right.merge(right_tail);
+    KpiHistogram swapped = c;
+    swapped.merge(a);
+    swapped.merge(b);
+
+    expect(same(left, right), "merge is associative");
+    expect(same(left, swapped), "merge is commutative");
+    expect(left.count() == 15000, "merged count");
+
+    KpiHistogram with_empty = a;
+    with_empty.merge(KpiHistogram());
+    expect(same(with_empty, a), "merging an empty histogram changes nothing");
+}
+
+void test_chunk_round_trip() {
+    TransitNetwork network;
+    LineKpis sent(network, 0);
+    std::mt19937 rng(42);
+    std::lognormal_distribution<> value(11.0, 1.5);
+    for (int i = 0; i < 20000; ++i) {
+        sent.record(static_cast<Kpi>(i % kKpiCount), i % sent.stop_count(), static_cast<unsigned long long>(value(rng)));
+    }
+    std::vector<KpiChunk> chunks;
+    sent.append_chunks(chunks);
+    expect(chunks.size() > static_cast<size_t>(kKpiCount * sent.stop_count()), "series span several chunks");
+
+    LineKpis received(network, 0);
+#ifdef SUBWAY_HAS_FORK
+    SharedMemoryChannels channels(1);
+    expect(channels.valid(), "shared memory rings");
+    if (!channels.valid()) return;
+    int parent = static_cast<int>(getpid());
+    pid_t pid = fork();
+    if (pid == 0) {
+        SharedMemoryTransport transport = channels.worker_end(0, parent);
+        bool ok = true;
+        for (const auto& chunk : chunks) {
+            ok = ok && transport.send(ShardMessage::kpi_chunk(0, chunk));
+        }
+        ok = ok && transport.send(ShardMessage::control(ShardMessage::Finished, 0));
+        _exit(ok ? 0 : 1);
+    }
+    expect(pid > 0, "fork");
+    if (pid <= 0) return;
+
+    SharedMemoryTransport transport = channels.coordinator_end(0, static_cast<int>(pid));
+    ShardMessage message;
+    while (transport.receive(message) && message.kind != ShardMessage::Finished) {
+        if (message.kind == ShardMessage::Kpis) received.absorb(message.kpis);
+    }
+    waitpid(pid, nullptr, 0);
+#else
+    for (const auto& chunk : chunks) {
+        received.absorb(chunk);
+    }
+#endif
+
+    bool all_same = true;
+    for (int kpi = 0; kpi < kKpiCount; ++kpi) {
+        for (int stop = 0; stop < sent.stop_count(); ++stop) {
+            all_same = all_same && same(sent.series(static_cast<Kpi>(kpi), stop), received.series(static_cast<Kpi>(kpi), stop));
+        }
+    }
+    expect(all_same, "chunks rebuild every series exactly, min and max included");
+}
+
+} // namespace
+
+int main() {
+    test_bucket_bounds();
+    test_percentiles();
+    test_merge();
+    test_chunk_round_trip();
+
+    return finish("KPI histograms behave");
+}
@@ -0,0 +1,102 @@
+#include "StationDemand.h"
+#include "TestSupport.h"
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+// The demand profile's cumulative table, the O(1) catch-up of a platform
+// queue, and how riders left behind by full trains are counted.
+
+namespace {
+
+const long long kMsPerMinute = 60LL * 1000;
+const long long kMsPerHour = 60 * kMsPerMinute;
+
+bool same_value(double a, double b) {
+    return std::fabs(a - b) <= 1e-6 * std::max(1.0, std::fabs(b));
+}
+
+void test_profile() {
+    DemandProfile profile;
+    double day = 0.0;
+    for (int hour = 0; hour < 24; ++hour) {
+        day += profile.multiplier(hour * kMsPerHour);
+    }
+    expect(same_value(profile.arrivals(0, 24 * kMsPerHour), day), "a whole day sums the hourly multipliers");
+    expect(same_value(profile.arrivals(30 * kMsPerHour, 54 * kMsPerHour), day), "any 24 hours sum to one day");
+
+    // The closed form matches adding up minute by minute, across midnight too.
+    double summed = 0.0;
+    for (long long t = 5 * kMsPerHour; t < 29 * kMsPerHour + 30 * kMsPerMinute; t += kMsPerMinute) {
+        summed += profile.multiplier(t) / 60.0;
+    }
+    expect(same_value(profile.arrivals(5 * kMsPerHour, 29 * kMsPerHour + 30 * kMsPerMinute), summed),
+           "arrivals match a minute-by-minute sum");
+}
+
+void test_catch_up(const TransitNetwork& network) {
+    const long long start = 6 * kMsPerHour;
+    const int line = 0;
+    const int station = network.route(line).stop(0);
+    DemandProfile profile;
+
+    // One catch-up over three hours equals a train calling every minute with no room.
+    StationQueues once(network, profile, start);
+    StationQueues every_minute(network, profile, start);
+    for (long long t = start + kMsPerMinute; t <= start + 3 * kMsPerHour; t += kMsPerMinute) {
+        every_minute.board(line, station, t, 0);
+    }
+    once.board(line, station, start + 3 * kMsPerHour, 0);
+    expect(once.waiting(line, station) > 0.0, "riders arrive");
+    expect(same_value(once.waiting(line, station), every_minute.waiting(line, station)), "catch-up is independent of call count");
+
+    // Waiting riders follow DemandProfile::arrivals, so within one hour they
+    // grow with the headway.
+    const long long peak = 8 * kMsPerHour;
+    StationQueues short_headway(network, profile, peak);
+    StationQueues long_headway(network, profile, peak);
+    short_headway.board(line, station, peak + 2 * kMsPerMinute, 0);
+    long_headway.board(line, station, peak + 10 * kMsPerMinute, 0);
+    expect(same_value(long_headway.waiting(line, station), 5.0 * short_headway.waiting(line, station)),
+           "five times the headway, five times the riders");
+
+    double per_arrival = once.waiting(line, station) / profile.arrivals(start, start + 3 * kMsPerHour);
+    expect(same_value(short_headway.waiting(line, station), per_arrival * profile.arrivals(peak, peak + 2 * kMsPerMinute)),
+           "waiting riders follow the profile");
+}
+
+void test_denied(const TransitNetwork& network) {
+    // Every call happens at the start time, so no profile arrivals mix in.
+    const long long now = 6 * kMsPerHour;
+    const int line = 0;
+    const int station = network.route(line).stop(0);
+    StationQueues queues(network, DemandProfile(), now);
+
+    queues.add_waiting(line, station, now, 100);
+    auto first = queues.board(line, station, now, 30);
+    expect(first.boarded == 30 && first.denied == 70, "100 waiting, room for 30: 70 denied");
+
+    // The 70 left behind board first; 20 of them and 30 newcomers stay.
+    queues.add_waiting(line, station, now, 30);
+    auto second = queues.board(line, station, now, 50);
+    expect(second.boarded == 50 && second.denied == 30,
+           "next train, room for 50: only the 30 newcomers are newly denied, got " + std::to_string(second.denied));
+
+    auto third = queues.board(line, station, now, 10);
+    expect(third.boarded == 10 && third.denied == 0, "riders already left behind are not counted again");
+
+    auto last = queues.board(line, station, now, 500);
+    expect(last.boarded == 40 && last.denied == 0, "an empty train takes everyone");
+    expect(queues.waiting(line, station) == 0.0, "platform cleared");
+}
+
+} // namespace
+
+int main() {
+    TransitNetwork network;
+    test_profile();
+    test_catch_up(network);
+    test_denied(network);
+
+    return finish("station queues behave");
+}
@@ -0,0 +1,27 @@
+#ifndef TEST_SUPPORT_H
+#define TEST_SUPPORT_H
+
+#include <cstdio>
+#include <string>
+
+// Minimal checks shared by the test programs: expect() reports a failure and
+// keeps going, finish() prints the success line and yields the exit code.
+
+inline int& test_failures() {
+    static int failures = 0;
+    return failures;
+}
+
+inline void expect(bool condition, const std::string& what) {
+    if (!condition) {
+        std::printf("FAIL: %s\n", what.c_str());
+        ++test_failures();
+    }
+}
+
+inline int finish(const char* success) {
+    if (test_failures() == 0) std::printf("%s\n", success);
+    return test_failures() == 0 ? 0 : 1;
+}
+
+#endif // TEST_SUPPORT_H
@@ -0,0 +1,113 @@
+#include "Timetable.h"
+#include "TestSupport.h"
+#include <cmath>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+// Compiled timetables against the round trip they describe, headway
+// stretching and depot trains, and the closed-form score.
+
+namespace {
+
+const long long kMinute = 60 * 1000;
+
+void test_round_trip(const TransitNetwork& network, const TimetableCompiler& compiler, int line) {
+    const auto& route = network.route(line);
+    std::string name = std::string(route.name) + ": ";
+    LineTimetable timetable = compiler.compile(line, 5 * kMinute, 4);
+    const int visits = timetable.visits_per_cycle();
+    expect(visits == 2 * (route.stop_count - 1), name + "a round trip visits every stop but the ends twice");
+    expect(route.stop(timetable.start_stop) == route.hub, name + "starts at the hub");
+    expect(timetable.visit_stop[0] == timetable.start_stop, name + "first visit is the hub");
+
+    std::vector<int> calls(route.stop_count, 0);
+    for (int v = 0; v < visits; ++v) {
+        int stop = timetable.visit_stop[v];
+        int next = timetable.visit_stop[(v + 1) % visits];
+        calls[stop]++;
+        expect(std::abs(next - stop) == 1, name + "visit " + std::to_string(v) + " heads to a neighbouring stop");
+        if (v == 0) expect(next - stop == timetable.start_direction, name + "leaves the hub in start_direction");
+    }
+    for (int stop = 0; stop < route.stop_count; ++stop) {
+        int expected = stop == 0 || stop == route.stop_count - 1 ? 1 : 2;
+        expect(calls[stop] == expected, name + "stop " + std::to_string(stop) + " called " + std::to_string(calls[stop]) + " times");
+    }
+
+    expect(timetable.departure(0, 0) == timetable.first_departure_ms, name + "first departure");
+    for (int train = 0; train < timetable.trains_in_service; ++train) {
+        for (long long visit = 0; visit < 3LL * visits; ++visit) {
+            long long departs = timetable.departure(train, visit);
+            bool ok = timetable.departure(train, visit + visits) - departs == timetable.cycle_ms &&
+                      timetable.departure(train, visit + 1) > departs;
+            if (train + 1 < timetable.trains_in_service) {
+                ok = ok && timetable.departure(train + 1, visit) - departs == timetable.headway_ms;
+            }
+            if (!ok) {
+                expect(false, name + "departure(" + std::to_string(train) + ", " + std::to_string(visit) + ")");
+                return;
+            }
+        }
+    }
+}
+
+void test_fleet_sizing(const TimetableCompiler& compiler, int line) {
+    LineTimetable one = compiler.compile(line, 60 * kMinute, 1);
+    long long round_trip = one.min_cycle_ms;
+
+    // Too few trains for the headway: all run, further apart.
+    LineTimetable stretched = compiler.compile(line, kMinute, 2);
+    expect(stretched.trains_in_service == 2, "a short fleet runs every train");
+    expect(stretched.headway_ms >= kMinute && 2 * stretched.headway_ms >= round_trip, "the headway stretches to cover the round trip");
+    expect(stretched.headway_ms % 1000 == 0, "headways are whole seconds");
+
+    // More trains than the headway needs: the rest stay in the depot.
+    long long headway = round_trip / 3 + 1000;
+    LineTimetable surplus = compiler.compile(line, headway, 10);
+    expect(surplus.trains_in_service == 3, "surplus trains stay in the depot, " + std::to_string(surplus.trains_in_service) + " in service");
+    expect(surplus.headway_ms >= headway, "no stretching needed");
+    expect(surplus.cycle_ms >= round_trip && surplus.cycle_ms - round_trip < surplus.headway_ms,
+           "the layover at the hub is shorter than one headway");
+
+    expect(compiler.compile(line, headway, 0).trains_in_service == 0, "no fleet, no service");
+}
+
+void test_score(const TransitNetwork& network, int line) {
+    DemandProfile profile;
+    const long long start = 6 * 60 * kMinute;
+    TimetableCompiler compiler(network);
+    expect(std::isinf(compiler.score(compiler.compile(line, 5 * kMinute, 0), profile, start)), "no service scores infinity");
+
+    // Waiting alone: shorter headways always score better.
+    TimetableParams waiting_only;
+    waiting_only.train_hour_cost = 0.0;
+    waiting_only.overflow_penalty = 0.0;
+    TimetableCompiler waiting(network, waiting_only);
+    double frequent = waiting.score(waiting.compile(line, 4 * kMinute, 50), profile, start);
+    double sparse = waiting.score(waiting.compile(line, 12 * kMinute, 50), profile, start);
+    expect(frequent > 0.0 && frequent < sparse, "longer headways keep riders waiting longer");
+
+    // Train-hours alone: a timetable costs its trains in service.
+    TimetableParams fleet_only;
+    fleet_only.value_of_time = 0.0;
+    fleet_only.overflow_penalty = 0.0;
+    TimetableCompiler fleet(network, fleet_only);
+    LineTimetable timetable = fleet.compile(line, 4 * kMinute, 50);
+    double expected = timetable.trains_in_service * fleet_only.service_hours * fleet_only.train_hour_cost;
+    expect(std::fabs(fleet.score(timetable, profile, start) - expected) < 1e-9, "train-hours are costed per train in service");
+}
+
+} // namespace
+
+int main() {
+    TransitNetwork network;
+    TimetableCompiler compiler(network);
+    for (int line = 0; line < network.route_count(); ++line) {
+        if (network.route(line).stop_count < 2) continue;
+        test_round_trip(network, compiler, line);
+        test_fleet_sizing(compiler, line);
+    }
+    test_score(network, network.route_index("Red"));
+
+    return finish("timetables behave");
+}
@@ -0,0 +1,88 @@
+#include "TimingWheel.h"
+#include "TestSupport.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Delays longer than a turn of the wheel, and a parked task woken by another.
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Probe {
+    std::atomic<int> calls{0};
+    Clock::time_point first;
+    Clock::time_point second;
+};
+
+long long elapsed_ms(Clock::time_point from, Clock::time_point to) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(to - from).count();
+}
+
+// Each task asks for one delay and finishes when it comes back.
+void test_long_delays(size_t slots, const std::vector<int>& delays_ms) {
+    TimingWheel wheel(2, std::chrono::milliseconds(1), slots);
+    std::vector<std::unique_ptr<Probe>> probes;
+    for (int delay : delays_ms) {
+        probes.emplace_back(new Probe());
+        Probe* probe = probes.back().get();
+        wheel.add([probe, delay] {
+            int call = ++probe->calls;
+            if (call == 1) {
+                probe->first = Clock::now();
+                return delay;
+            }
+            probe->second = Clock::now();
+            return -1;
+        });
+    }
+    wheel.run();
+
+    std::string wheel_name = std::to_string(slots) + " slots, ";
+    for (size_t i = 0; i < delays_ms.size(); ++i) {
+        std::string name = wheel_name + std::to_string(delays_ms[i]) + " ms";
+        expect(probes[i]->calls == 2, name + ": ran " + std::to_string(probes[i]->calls.load()) + " times, not twice");
+        expect(elapsed_ms(probes[i]->first, probes[i]->second) >= delays_ms[i], name + ": ran early");
+    }
+}
+
+void test_wake() {
+    TimingWheel wheel(2);
+    Probe parked;
+    Probe waker;
+    std::atomic<bool> woken{false};
+
+    size_t parked_task = wheel.add([&] {
+        int call = ++parked.calls;
+        if (call == 1) return TimingWheel::kParked;
+        parked.second = Clock::now();
+        return -1;
+    });
+    wheel.add([&, parked_task] {
+        int call = ++waker.calls;
+        if (call == 1) return 50;
+        waker.second = Clock::now();
+        woken = true;
+        wheel.wake(parked_task);
+        return -1;
+    });
+    wheel.run();
+
+    expect(woken, "waker ran");
+    expect(parked.calls == 2, "parked task resumed once, ran " + std::to_string(parked.calls.load()) + " times");
+    expect(parked.second >= waker.second, "parked task resumed only after wake()");
+    expect(wheel.stats().wakeups == 4, "every step was a wakeup");
+}
+
+} // namespace
+
+int main() {
+    test_long_delays(512, {5, 600, 1100});
+    test_long_delays(8, {3, 8, 9, 17, 50});
+    test_wake();
+
+    return finish("timing wheel behaves");
+}